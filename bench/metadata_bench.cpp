@@ -0,0 +1,148 @@
+// Benchmark de contención del índice de metadatos: N hilos mezclando subidas (put) y
+// descargas (get), como los hilos de httplib atendiendo /upload y /download.
+//   MetadataBench [hilos=64] [segundos=3] [% de subidas=5] [directorio=bench_metadata]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "metadata_store.hpp"
+#include "sharded_map.hpp"
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    uint64_t gets = 0;
+    uint64_t puts = 0;
+    std::vector<double> get_us;
+    std::vector<double> put_us;
+};
+
+double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) return 0;
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(p / 100.0 * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+FileMetadata sample_meta(size_t size) {
+    FileMetadata meta;
+    meta.layout.file_size = size;
+    meta.codec = "xor";
+    return meta;
+}
+
+// Corre fn(hilo, rng, resultado) en todos los hilos durante seconds y junta los resultados
+template <class Fn>
+Result run(size_t threads, double seconds, Fn fn) {
+    std::vector<Result> results(threads);
+    std::vector<std::thread> workers;
+    std::atomic<bool> stop{false};
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            std::mt19937_64 rng(t + 1);
+            while (!stop) fn(t, rng, results[t]);
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto& worker : workers) worker.join();
+
+    Result total;
+    for (auto& r : results) {
+        total.gets += r.gets;
+        total.puts += r.puts;
+        total.get_us.insert(total.get_us.end(), r.get_us.begin(), r.get_us.end());
+        total.put_us.insert(total.put_us.end(), r.put_us.begin(), r.put_us.end());
+    }
+    return total;
+}
+
+void report(const std::string& name, Result& r, double seconds) {
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(12) << (r.gets + r.puts) / seconds << " ops/s"
+              << "  get p50/p99 " << std::setprecision(2) << percentile(r.get_us, 50) << "/"
+              << percentile(r.get_us, 99) << " us";
+    if (!r.put_us.empty()) {
+        std::cout << "  put p50/p99 " << percentile(r.put_us, 50) << "/" << percentile(r.put_us, 99) << " us";
+    }
+    std::cout << "\n";
+}
+
+double elapsed_us(Clock::time_point since) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - since).count();
+}
+
+// Solo el mapa en memoria: compara un candado único con el mapa dividido en partes
+template <class Map>
+void bench_map(const std::string& name, size_t threads, double seconds, int put_percent) {
+    Map map;
+    const size_t preload = 100000;
+    for (size_t i = 0; i < preload; i++) map.insert_or_assign("file_" + std::to_string(i), sample_meta(i));
+    std::atomic<size_t> next{preload};
+
+    Result r = run(threads, seconds, [&](size_t, std::mt19937_64& rng, Result& out) {
+        bool upload = static_cast<int>(rng() % 100) < put_percent;
+        auto start = Clock::now();
+        if (upload) {
+            size_t id = next++;
+            map.insert_or_assign("file_" + std::to_string(id), sample_meta(id));
+            out.puts++;
+            if (out.puts % 16 == 0) out.put_us.push_back(elapsed_us(start));
+        } else {
+            auto meta = map.find("file_" + std::to_string(rng() % next.load()));
+            out.gets++;
+            if (out.gets % 16 == 0) out.get_us.push_back(elapsed_us(start));
+        }
+    });
+    report(name, r, seconds);
+}
+
+int main(int argc, char** argv) {
+    size_t threads = argc > 1 ? std::stoul(argv[1]) : 64;
+    double seconds = argc > 2 ? std::stod(argv[2]) : 3;
+    int put_percent = argc > 3 ? std::stoi(argv[3]) : 5;
+    std::string dir = argc > 4 ? argv[4] : "bench_metadata";
+
+    std::cout << threads << " threads, " << seconds << " s each, " << put_percent << "% uploads\n";
+    bench_map<ShardedMap<std::string, FileMetadata, 1>>("map, single lock", threads, seconds, put_percent);
+    bench_map<ShardedMap<std::string, FileMetadata>>("map, 64 shards", threads, seconds, put_percent);
+
+    // Índice completo: cada subida espera su fsync (group commit), las descargas no
+    fs::remove_all(dir);
+    {
+        MetadataStore::Options options;
+        options.dir = dir;
+        MetadataStore store(options);
+        std::atomic<size_t> next{0};
+        for (; next < 1000; next++) store.put("file_" + std::to_string(next.load()), sample_meta(next));
+
+        Result r = run(threads, seconds, [&](size_t, std::mt19937_64& rng, Result& out) {
+            bool upload = static_cast<int>(rng() % 100) < put_percent;
+            auto start = Clock::now();
+            if (upload) {
+                size_t id = next++;
+                store.put("file_" + std::to_string(id), sample_meta(id));
+                out.puts++;
+                out.put_us.push_back(elapsed_us(start));
+            } else {
+                auto meta = store.get("file_" + std::to_string(rng() % next.load()));
+                out.gets++;
+                if (out.gets % 16 == 0) out.get_us.push_back(elapsed_us(start));
+            }
+        });
+        report("MetadataStore", r, seconds);
+        MetadataStore::Stats stats = store.stats();
+        std::cout << "  " << stats.records << " records in " << stats.commits << " fsyncs ("
+                  << std::setprecision(1) << static_cast<double>(stats.records) / std::max<uint64_t>(stats.commits, 1)
+                  << " per fsync), " << stats.compactions << " compactions, " << stats.files << " files\n";
+    }
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Benchmark de escrituras en sitio contra un controlador en marcha: sube un archivo con
+// ?updatable=1 y compara escrituras pequeñas en offsets aleatorios (PATCH /update, que solo
+// reescribe las unidades tocadas y la paridad) con volver a subir el archivo completo.
+//   PatchBench [controlador=http://localhost:8080] [MB del archivo=16] [escrituras=200]
+//              [bytes por escritura=4096] [subidas completas=5]
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "httplib.h"
+#include "json.hpp"
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) return 0;
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(p / 100.0 * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+double elapsed_ms(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+json status(httplib::Client& client) {
+    auto res = client.Get("/status");
+    if (!res || res->status != 200) throw std::runtime_error("GET /status failed");
+    return json::parse(res->body);
+}
+
+std::string upload(httplib::Client& client, const std::string& data) {
+    auto res = client.Post("/upload?updatable=1", data, "application/octet-stream");
+    if (!res || res->status != 200) throw std::runtime_error("Upload failed");
+    return json::parse(res->body).at("file_id").get<std::string>();
+}
+
+// bytes: lo que viajó entre el controlador y los nodos por operación
+void report(const std::string& name, std::vector<double>& ms, double total_ms, double bytes, double payload) {
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << ms.size() * 1000.0 / total_ms << " ops/s"
+              << "  p50/p99 " << std::setprecision(2) << percentile(ms, 50) << "/" << percentile(ms, 99) << " ms"
+              << "  node traffic " << std::setprecision(0) << bytes / 1024 << " KiB/op ("
+              << std::setprecision(1) << bytes / payload << "x the bytes changed)\n";
+}
+
+int main(int argc, char** argv) {
+    std::string url = argc > 1 ? argv[1] : "http://localhost:8080";
+    size_t file_size = (argc > 2 ? std::stoul(argv[2]) : 16) * 1024 * 1024;
+    size_t updates = argc > 3 ? std::stoul(argv[3]) : 200;
+    size_t update_size = argc > 4 ? std::stoul(argv[4]) : 4096;
+    size_t rewrites = argc > 5 ? std::stoul(argv[5]) : 5;
+    if (update_size == 0 || update_size > file_size) {
+        std::cerr << "Update size must be between 1 and the file size\n";
+        return 1;
+    }
+
+    httplib::Client client(url);
+    client.set_read_timeout(300);
+    client.set_write_timeout(300);
+    try {
+        json before = status(client);
+        size_t k = before.at("data_blocks").get<size_t>();
+        size_t m = before.at("parity_blocks").get<size_t>();
+        std::cout << "codec " << before.at("codec").get<std::string>() << " " << k << "+" << m << ", "
+                  << file_size / (1024 * 1024) << " MiB file, " << update_size << " bytes per update\n";
+
+        std::mt19937_64 rng(42);
+        std::string data(file_size, '\0');
+        for (auto& c : data) c = static_cast<char>(rng());
+        std::string file_id = upload(client, data);
+
+        // Escrituras en sitio
+        std::vector<double> patch_ms;
+        uint64_t node_bytes = status(client).at("patch_node_bytes").get<uint64_t>();
+        auto start = Clock::now();
+        for (size_t i = 0; i < updates; i++) {
+            size_t offset = rng() % (file_size - update_size + 1);
+            std::string chunk(update_size, '\0');
+            for (auto& c : chunk) c = static_cast<char>(rng());
+            auto op = Clock::now();
+            auto res = client.Patch("/update/" + file_id + "?offset=" + std::to_string(offset), chunk,
+                                    "application/octet-stream");
+            if (!res || res->status != 200) throw std::runtime_error("PATCH failed" + (res ? ": " + res->body : ""));
+            patch_ms.push_back(elapsed_ms(op));
+            data.replace(offset, update_size, chunk);
+        }
+        double patch_total = elapsed_ms(start);
+        node_bytes = status(client).at("patch_node_bytes").get<uint64_t>() - node_bytes;
+        report("in-place update", patch_ms, patch_total, static_cast<double>(node_bytes) / updates, update_size);
+
+        // El archivo descargado tiene que coincidir con la copia local
+        auto res = client.Get("/download/" + file_id);
+        if (!res || res->status != 200 || res->body != data) {
+            std::cerr << "Downloaded file does not match the updates\n";
+            return 1;
+        }
+
+        // Alternativa sin escrituras en sitio: subir otra vez el archivo completo (se escriben
+        // todas las unidades de datos y de paridad)
+        std::vector<double> rewrite_ms;
+        start = Clock::now();
+        for (size_t i = 0; i < rewrites; i++) {
+            size_t offset = rng() % (file_size - update_size + 1);
+            data[offset] = static_cast<char>(data[offset] ^ 1);
+            auto op = Clock::now();
+            upload(client, data);
+            rewrite_ms.push_back(elapsed_ms(op));
+        }
+        double rewrite_total = elapsed_ms(start);
+        double rewrite_bytes = static_cast<double>(file_size) * (k + m) / k;
+        report("full rewrite", rewrite_ms, rewrite_total, rewrite_bytes, update_size);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Reparto de la carga por nodo según la ubicación de la paridad: simula con StripeLayout, sin
+// nodos ni red, subidas de tamaños variados, escrituras en sitio pequeñas (cada una reescribe la
+// unidad de datos tocada y las m paridades de su franja) y la descarga de lo subido (las k
+// unidades de datos de cada franja, como una lectura sin fallas).
+//   PlacementBench [k=3] [m=1] [subidas=2000] [escrituras=200000] [bytes por escritura=4096]
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "stripe.hpp"
+
+struct Workload {
+    std::vector<size_t> upload_sizes;
+    std::vector<std::pair<size_t, size_t>> updates; // (offset, largo) en un archivo de update_file_size
+    size_t update_file_size = 0;
+};
+
+StripeLayout make_layout(size_t k, size_t m, size_t file_size, Placement placement) {
+    StripeLayout layout;
+    layout.k = k;
+    layout.m = m;
+    layout.file_size = file_size;
+    layout.placement = placement;
+    return layout;
+}
+
+// Bytes que se leen de cada nodo al descargar todo lo subido
+std::vector<double> simulate_reads(const Workload& work, size_t k, size_t m, Placement placement) {
+    std::vector<double> bytes(k + m, 0);
+    for (size_t size : work.upload_sizes) {
+        StripeLayout layout = make_layout(k, m, size, placement);
+        for (size_t s = 0; s < layout.stripe_count(); s++) {
+            for (size_t i = 0; i < k; i++) bytes[layout.node(s, i)] += layout.unit_length(s);
+        }
+    }
+    return bytes;
+}
+
+// Bytes que recibe cada nodo
+std::vector<double> simulate(const Workload& work, size_t k, size_t m, Placement placement) {
+    std::vector<double> bytes(k + m, 0);
+    for (size_t size : work.upload_sizes) {
+        StripeLayout layout = make_layout(k, m, size, placement);
+        for (size_t s = 0; s < layout.stripe_count(); s++) {
+            for (size_t i = 0; i < k + m; i++) bytes[layout.node(s, i)] += layout.unit_length(s);
+        }
+    }
+    StripeLayout layout = make_layout(k, m, work.update_file_size, placement);
+    for (auto [offset, length] : work.updates) {
+        size_t s = offset / layout.stripe_width();
+        size_t begin = offset - layout.stripe_offset(s);
+        size_t end = std::min(begin + length, layout.stripe_length(s));
+        size_t len = layout.unit_length(s);
+        for (size_t i = begin / len; i <= (end - 1) / len; i++) bytes[layout.node(s, i)] += len;
+        for (size_t j = 0; j < m; j++) bytes[layout.node(s, k + j)] += len;
+    }
+    return bytes;
+}
+
+void report(const std::string& name, const std::vector<double>& bytes) {
+    double total = 0, max = 0;
+    for (double b : bytes) {
+        total += b;
+        max = std::max(max, b);
+    }
+    double mean = total / bytes.size();
+    std::cout << std::left << std::setw(25) << name << std::right << std::fixed << std::setprecision(0);
+    for (double b : bytes) std::cout << std::setw(9) << b / (1024 * 1024);
+    std::cout << " MiB   max/mean " << std::setprecision(2) << max / mean << "\n";
+}
+
+int main(int argc, char** argv) {
+    size_t k = argc > 1 ? std::stoul(argv[1]) : 3;
+    size_t m = argc > 2 ? std::stoul(argv[2]) : 1;
+    size_t uploads = argc > 3 ? std::stoul(argv[3]) : 2000;
+    size_t updates = argc > 4 ? std::stoul(argv[4]) : 200000;
+    size_t update_size = argc > 5 ? std::stoul(argv[5]) : 4096;
+
+    // Tamaños log-uniformes entre 1 KiB y 64 MiB; escrituras uniformes en un archivo de 1 GiB
+    std::mt19937_64 rng(7);
+    Workload work;
+    std::uniform_real_distribution<double> log_size(10, 26);
+    for (size_t i = 0; i < uploads; i++) work.upload_sizes.push_back(static_cast<size_t>(std::exp2(log_size(rng))));
+    work.update_file_size = size_t{1} << 30;
+    for (size_t i = 0; i < updates; i++) {
+        work.updates.emplace_back(rng() % (work.update_file_size - update_size), update_size);
+    }
+
+    std::cout << k << "+" << m << ", " << uploads << " uploads, " << updates << " updates of "
+              << update_size << " bytes; bytes per node:\n";
+    Workload only_uploads{work.upload_sizes, {}, work.update_file_size};
+    Workload only_updates{{}, work.updates, work.update_file_size};
+    report("upload writes, fixed", simulate(only_uploads, k, m, Placement::Fixed));
+    report("upload writes, rotating", simulate(only_uploads, k, m, Placement::Rotating));
+    report("update writes, fixed", simulate(only_updates, k, m, Placement::Fixed));
+    report("update writes, rotating", simulate(only_updates, k, m, Placement::Rotating));
+    report("reads, fixed", simulate_reads(work, k, m, Placement::Fixed));
+    report("reads, rotating", simulate_reads(work, k, m, Placement::Rotating));
+    return 0;
+}
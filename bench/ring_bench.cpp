@@ -0,0 +1,85 @@
+// Anillo de nodos (placement "hashed"): reparto de las unidades entre N nodos, qué parte de las
+// unidades cambia de nodo al agregar uno y cuánto cuesta elegir los nodos de una franja.
+//   RingBench [k=4] [m=2] [franjas=200000]
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "node_ring.hpp"
+
+std::vector<std::string> node_names(size_t n) {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < n; i++) names.push_back("http://10.0.0." + std::to_string(i + 1) + ":5001");
+    return names;
+}
+
+std::vector<uint16_t> place_all(const NodeRing& ring, size_t stripes) {
+    std::vector<uint16_t> out(stripes * ring.width());
+    for (size_t s = 0; s < stripes; s++) ring.place("file_bench", s, out.data() + s * ring.width());
+    return out;
+}
+
+// Máximo y mínimo de unidades por nodo respecto de lo que le tocaría según su peso
+void balance(const std::vector<uint16_t>& placed, const std::vector<double>& weights, double& max, double& min) {
+    std::vector<double> units(weights.size(), 0);
+    for (uint16_t node : placed) units[node]++;
+    double total_weight = 0;
+    for (double w : weights) total_weight += w;
+    max = 0;
+    min = 1e9;
+    for (size_t i = 0; i < weights.size(); i++) {
+        double expected = placed.size() * weights[i] / total_weight;
+        max = std::max(max, units[i] / expected);
+        min = std::min(min, units[i] / expected);
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t k = argc > 1 ? std::stoul(argv[1]) : 4;
+    size_t m = argc > 2 ? std::stoul(argv[2]) : 2;
+    size_t stripes = argc > 3 ? std::stoul(argv[3]) : 200000;
+    size_t width = k + m;
+    std::cout << k << "+" << m << ", " << stripes << " stripes\n";
+    std::cout << std::setw(6) << "nodes" << std::setw(14) << "max/expected" << std::setw(14) << "min/expected"
+              << std::setw(16) << "moved on +1" << std::setw(14) << "ideal" << std::setw(14) << "ns/stripe\n";
+
+    for (size_t n : {width, width + 2, size_t{16}, size_t{64}, size_t{256}, size_t{1024}}) {
+        if (n < width) continue;
+        std::vector<std::string> names = node_names(n + 1);
+        std::vector<double> weights(n, 1.0);
+        NodeRing ring({names.begin(), names.begin() + n}, weights, width);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<uint16_t> before = place_all(ring, stripes);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / stripes;
+        double max, min;
+        balance(before, weights, max, min);
+
+        // Un nodo más: se cuentan las unidades de nodos que dejaron de estar entre los de su
+        // franja (las de los nodos que siguen no se mueven aunque cambie su posición)
+        NodeRing grown(names, std::vector<double>(n + 1, 1.0), width);
+        std::vector<uint16_t> after = place_all(grown, stripes);
+        size_t moved = 0;
+        for (size_t s = 0; s < stripes; s++) {
+            auto first = after.begin() + s * width;
+            for (size_t i = 0; i < width; i++) moved += std::find(first, first + width, before[s * width + i]) == first + width;
+        }
+
+        std::cout << std::fixed << std::setprecision(3) << std::setw(6) << n << std::setw(14) << max
+                  << std::setw(14) << min << std::setw(15) << 100.0 * moved / before.size() << "%"
+                  << std::setw(13) << 100.0 / (n + 1) << "%" << std::setw(13) << std::setprecision(0)
+                  << ns << "\n";
+    }
+
+    // Pesos distintos: la mitad de los nodos con el doble de capacidad
+    size_t n = 16;
+    std::vector<double> weights(n, 1.0);
+    for (size_t i = 0; i < n / 2; i++) weights[i] = 2.0;
+    NodeRing weighted(node_names(n), weights, width);
+    double max, min;
+    balance(place_all(weighted, stripes), weights, max, min);
+    std::cout << "16 nodes, half with weight 2: max/expected " << std::setprecision(3) << max
+              << ", min/expected " << min << "\n";
+    return 0;
+}
@@ -0,0 +1,294 @@
+#include "chunk_index.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include "durable_file.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Formato en disco (ver durable_file.hpp):
+//   chunks.log: registros [u8 op][u64 seq de la subida] seguidos de
+//     OP_CONTAINER: [u32 índice][u16 largo][id]
+//     OP_ADD:       [entrada de 28 bytes]
+//     OP_REF:       [huella de 12 bytes][u32 referencias]
+//   chunks.bin: "P3CHUNK1" u32 versión, u32 contenedores, u64 entradas, u64 referencias,
+//               u64 bytes, u64 último seq incluido; ids de contenedores ([u16 largo][id]);
+//               entradas ordenadas
+constexpr char SNAPSHOT_MAGIC[8] = {'P', '3', 'C', 'H', 'U', 'N', 'K', '1'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr size_t SNAPSHOT_HEADER = 48;
+constexpr uint8_t OP_CONTAINER = 1;
+constexpr uint8_t OP_ADD = 2;
+constexpr uint8_t OP_REF = 3;
+
+} // namespace
+
+ChunkIndex::ChunkIndex(Options options) : options_(std::move(options)) {
+    fs::create_directories(options_.dir);
+    log_path_ = (fs::path(options_.dir) / "chunks.log").string();
+    snapshot_path_ = (fs::path(options_.dir) / "chunks.bin").string();
+    load();
+    log_fd_ = open_file(log_path_, true);
+}
+
+ChunkIndex::~ChunkIndex() {
+    close_file(log_fd_);
+}
+
+void ChunkIndex::load() {
+    uint64_t snapshot_seq = 0;
+    std::string snapshot = read_file(snapshot_path_);
+    if (!snapshot.empty()) {
+        if (snapshot.size() < SNAPSHOT_HEADER || snapshot.compare(0, 8, SNAPSHOT_MAGIC, 8) != 0) {
+            throw std::runtime_error("Corrupt chunk index " + snapshot_path_);
+        }
+        RecordReader in(reinterpret_cast<const uint8_t*>(snapshot.data()) + 8, snapshot.size() - 8);
+        if (in.read<uint32_t>() != SNAPSHOT_VERSION) throw std::runtime_error("Unsupported chunk index version");
+        uint32_t containers = in.read<uint32_t>();
+        uint64_t entries = in.read<uint64_t>();
+        references_ = in.read<uint64_t>();
+        stored_bytes_ = in.read<uint64_t>();
+        snapshot_seq = in.read<uint64_t>();
+        for (uint32_t i = 0; i < containers; i++) apply_container(i, in.read_string(in.read<uint16_t>()));
+        if (in.remaining() != entries * sizeof(Entry)) throw std::runtime_error("Corrupt chunk index " + snapshot_path_);
+        sorted_.resize(entries);
+        std::memcpy(sorted_.data(), snapshot.data() + snapshot.size() - in.remaining(), in.remaining());
+    }
+
+    std::string log = read_file(log_path_);
+    commit_seq_ = snapshot_seq;
+    size_t valid = read_records(log, [&](RecordReader& record) {
+        uint8_t op = record.read<uint8_t>();
+        uint64_t seq = record.read<uint64_t>();
+        // Registros que ya estaban en el snapshot (el proceso cayó antes de vaciar el log)
+        bool applied = seq <= snapshot_seq;
+        commit_seq_ = std::max(commit_seq_, seq);
+        if (op == OP_CONTAINER) {
+            uint32_t index = record.read<uint32_t>();
+            std::string id = record.read_string(record.read<uint16_t>());
+            if (!applied) apply_container(index, id);
+        } else if (op == OP_ADD) {
+            Entry entry = record.read<Entry>();
+            if (!applied) apply_add(entry);
+        } else if (op == OP_REF) {
+            Fingerprint fp = record.read<Fingerprint>();
+            uint32_t count = record.read<uint32_t>();
+            if (!applied) apply_ref(fp, count);
+        } else {
+            return false;
+        }
+        return true;
+    });
+    if (valid < log.size()) {
+        std::cerr << "Discarding " << log.size() - valid << " bytes of incomplete chunk log\n";
+        fs::resize_file(log_path_, valid);
+    }
+    log_bytes_ = valid;
+}
+
+const ChunkIndex::Entry* ChunkIndex::locate(const Fingerprint& fp) const {
+    auto it = recent_.find(fp);
+    if (it != recent_.end()) return &it->second;
+    auto pos = std::lower_bound(sorted_.begin(), sorted_.end(), fp,
+                                [](const Entry& entry, const Fingerprint& key) { return entry.fp < key; });
+    if (pos != sorted_.end() && pos->fp == fp) return &*pos;
+    return nullptr;
+}
+
+ChunkIndex::Entry* ChunkIndex::locate(const Fingerprint& fp) {
+    return const_cast<Entry*>(static_cast<const ChunkIndex*>(this)->locate(fp));
+}
+
+std::optional<ChunkLocation> ChunkIndex::find(const Fingerprint& fp) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Entry* entry = locate(fp);
+    if (!entry) return std::nullopt;
+    return ChunkLocation{containers_[entry->container], entry->offset(), entry->length()};
+}
+
+void ChunkIndex::apply_container(uint32_t index, const std::string& id) {
+    if (index != containers_.size()) throw std::runtime_error("Out of order container in chunk index");
+    containers_.push_back(id);
+    container_ids_.emplace(id, index);
+}
+
+void ChunkIndex::apply_add(const Entry& entry) {
+    if (entry.container >= containers_.size()) throw std::runtime_error("Unknown container in chunk index");
+    references_ += entry.refs;
+    // Huella duplicada (logs anteriores a que commit() las convirtiera en OP_REF): las
+    // referencias van a la entrada que ya estaba
+    if (Entry* existing = locate(entry.fp)) {
+        existing->refs += entry.refs;
+        return;
+    }
+    recent_.emplace(entry.fp, entry);
+    stored_bytes_ += entry.length();
+    if (recent_.size() > std::max<size_t>(4096, sorted_.size() / 16)) merge();
+}
+
+void ChunkIndex::apply_ref(const Fingerprint& fp, uint32_t count) {
+    references_ += count;
+    if (Entry* entry = locate(fp)) entry->refs += count;
+}
+
+// Funde las entradas recientes en el arreglo ordenado (el arreglo nuevo se reserva justo)
+void ChunkIndex::merge() {
+    std::vector<Entry> fresh;
+    fresh.reserve(recent_.size());
+    for (const auto& [fp, entry] : recent_) fresh.push_back(entry);
+    auto by_fp = [](const Entry& a, const Entry& b) { return a.fp < b.fp; };
+    std::sort(fresh.begin(), fresh.end(), by_fp);
+
+    std::vector<Entry> merged;
+    merged.reserve(sorted_.size() + fresh.size());
+    std::merge(sorted_.begin(), sorted_.end(), fresh.begin(), fresh.end(), std::back_inserter(merged), by_fp);
+    sorted_.swap(merged);
+    recent_.clear();
+}
+
+void ChunkIndex::commit(const std::string& container, const std::vector<NewChunk>& added,
+                        const std::vector<Fingerprint>& referenced) {
+    std::lock_guard<std::mutex> log_lock(log_mutex_);
+    if (failed_) throw std::runtime_error("Chunk log is unavailable");
+
+    // Solo este hilo agrega contenedores, así que el índice asignado no cambia
+    std::optional<uint32_t> container_index;
+    bool new_container = false;
+    if (!added.empty()) {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = container_ids_.find(container);
+        if (it != container_ids_.end()) {
+            container_index = it->second;
+        } else {
+            container_index = static_cast<uint32_t>(containers_.size());
+            new_container = true;
+        }
+    }
+
+    // Otra subida pudo registrar la misma huella después de que esta la buscara: como solo
+    // commit() agrega entradas y lo hace con log_mutex_ tomado, lo que se ve acá no cambia hasta
+    // terminar. Esos chunks quedan sin índice en este contenedor y sus apariciones se cuentan
+    // como referencias a la entrada que ya estaba.
+    std::map<Fingerprint, uint32_t> refs;
+    for (const auto& fp : referenced) refs[fp]++;
+    std::vector<Entry> entries;
+    for (const auto& chunk : added) {
+        if (chunk.length > MAX_CHUNK || chunk.offset >> 44) throw std::runtime_error("Chunk out of index range");
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            if (locate(chunk.fp)) {
+                refs[chunk.fp] += chunk.refs;
+                continue;
+            }
+        }
+        Entry entry;
+        entry.fp = chunk.fp;
+        entry.container = *container_index;
+        entry.offset_low = static_cast<uint32_t>(chunk.offset);
+        entry.offset_high_length = static_cast<uint32_t>(chunk.offset >> 32) << 20 | chunk.length;
+        entry.refs = chunk.refs;
+        entries.push_back(entry);
+    }
+    if (entries.empty()) new_container = false;
+
+    uint64_t seq = commit_seq_ + 1;
+    auto record = [seq](uint8_t op) {
+        std::string payload;
+        append_int<uint8_t>(payload, op);
+        append_int<uint64_t>(payload, seq);
+        return payload;
+    };
+
+    std::string buffer;
+    if (new_container) {
+        std::string payload = record(OP_CONTAINER);
+        append_int<uint32_t>(payload, *container_index);
+        append_int<uint16_t>(payload, static_cast<uint16_t>(container.size()));
+        payload += container;
+        append_record(buffer, payload);
+    }
+    for (const auto& entry : entries) {
+        std::string payload = record(OP_ADD);
+        append_int<Entry>(payload, entry);
+        append_record(buffer, payload);
+    }
+    for (const auto& [fp, count] : refs) {
+        std::string payload = record(OP_REF);
+        append_int<Fingerprint>(payload, fp);
+        append_int<uint32_t>(payload, count);
+        append_record(buffer, payload);
+    }
+    if (buffer.empty()) return;
+
+    try {
+        write_all(log_fd_, buffer);
+        sync_file(log_fd_);
+    } catch (...) {
+        // Lo que siga a un registro a medias se descartaría al reproducir el log
+        failed_ = true;
+        throw;
+    }
+    log_bytes_ += buffer.size();
+    commit_seq_ = seq;
+
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (new_container) apply_container(*container_index, container);
+        for (const auto& entry : entries) apply_add(entry);
+        for (const auto& [fp, count] : refs) apply_ref(fp, count);
+    }
+
+    if (log_bytes_ >= options_.compact_bytes) {
+        try {
+            compact();
+        } catch (const std::exception& e) {
+            std::cerr << "Chunk index compaction failed: " << e.what() << "\n";
+        }
+    }
+}
+
+// Reescribe chunks.bin con el índice completo y vacía el log (con log_mutex_ tomado)
+void ChunkIndex::compact() {
+    std::string out;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        merge();
+        out.append(SNAPSHOT_MAGIC, 8);
+        append_int<uint32_t>(out, SNAPSHOT_VERSION);
+        append_int<uint32_t>(out, static_cast<uint32_t>(containers_.size()));
+        append_int<uint64_t>(out, sorted_.size());
+        append_int<uint64_t>(out, references_);
+        append_int<uint64_t>(out, stored_bytes_);
+        append_int<uint64_t>(out, commit_seq_);
+        for (const auto& id : containers_) {
+            append_int<uint16_t>(out, static_cast<uint16_t>(id.size()));
+            out += id;
+        }
+        out.append(reinterpret_cast<const char*>(sorted_.data()), sorted_.size() * sizeof(Entry));
+    }
+    replace_file(snapshot_path_, out);
+
+    // Si el proceso cae antes de vaciar el log, sus registros tienen seq ya incluido y se ignoran
+    truncate_file(log_fd_);
+    sync_file(log_fd_);
+    log_bytes_ = 0;
+}
+
+ChunkIndex::Stats ChunkIndex::stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    Stats stats;
+    stats.chunks = sorted_.size() + recent_.size();
+    stats.containers = containers_.size();
+    stats.references = references_;
+    stats.stored_bytes = stored_bytes_;
+    // Nodo de unordered_map: entrada + puntero siguiente + hash, más un puntero por bucket
+    stats.memory_bytes = sorted_.capacity() * sizeof(Entry) +
+                         recent_.size() * (sizeof(Entry) + 2 * sizeof(void*)) +
+                         recent_.bucket_count() * sizeof(void*);
+    for (const auto& id : containers_) stats.memory_bytes += id.capacity() + sizeof(std::string) + 48;
+    return stats;
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "chunker.hpp"
+
+// Ubicación de un chunk ya guardado: rango dentro de las franjas de su contenedor
+struct ChunkLocation {
+    std::string container;
+    uint64_t offset = 0;
+    uint32_t length = 0;
+};
+
+// Chunk que una subida guardó por primera vez (refs: veces que aparece en ese archivo)
+struct NewChunk {
+    Fingerprint fp;
+    uint64_t offset = 0;
+    uint32_t length = 0;
+    uint32_t refs = 1;
+};
+
+// Índice huella -> ubicación y número de referencias de cada chunk único.
+// En memoria: arreglo ordenado de entradas empacadas de 28 bytes (búsqueda binaria) más un
+// mapa con las entradas recientes, que se funde en el arreglo al superar 1/16 de su tamaño.
+// En disco (options.dir): chunks.log con los cambios de cada subida (un fsync por subida) y
+// chunks.bin con el índice completo; cuando el log crece se reescribe chunks.bin y se vacía.
+class ChunkIndex {
+public:
+    struct Options {
+        std::string dir = "storage/controller";
+        size_t compact_bytes = 16 * 1024 * 1024;
+    };
+
+    struct Stats {
+        size_t chunks = 0;
+        size_t containers = 0;
+        uint64_t references = 0;   // apariciones de chunks en archivos
+        uint64_t stored_bytes = 0; // bytes de los chunks únicos
+        size_t memory_bytes = 0;   // estimación de la memoria del índice
+    };
+
+    // Los chunks no pueden medir más de MAX_CHUNK bytes
+    static constexpr uint32_t MAX_CHUNK = (1u << 20) - 1;
+
+    explicit ChunkIndex(Options options);
+    ~ChunkIndex();
+
+    ChunkIndex(const ChunkIndex&) = delete;
+    ChunkIndex& operator=(const ChunkIndex&) = delete;
+
+    std::optional<ChunkLocation> find(const Fingerprint& fp) const;
+
+    // Registra los chunks que guardó el contenedor y suma una referencia por cada aparición
+    // en referenced; vuelve cuando el cambio ya está en disco. Si otra subida registró antes
+    // la misma huella se conserva esa ubicación y se le suman las referencias de esta. Tras un error de escritura lanza siempre
+    // std::runtime_error: el índice deja de crecer pero las búsquedas siguen funcionando.
+    void commit(const std::string& container, const std::vector<NewChunk>& added,
+                const std::vector<Fingerprint>& referenced);
+
+    Stats stats() const;
+
+private:
+    // 28 bytes: huella, contenedor, offset de 44 bits y largo de 20 bits, referencias
+    struct Entry {
+        Fingerprint fp;
+        uint32_t container;
+        uint32_t offset_low;
+        uint32_t offset_high_length;
+        uint32_t refs;
+
+        uint64_t offset() const { return (static_cast<uint64_t>(offset_high_length >> 20) << 32) | offset_low; }
+        uint32_t length() const { return offset_high_length & MAX_CHUNK; }
+    };
+    static_assert(sizeof(Entry) == 28, "Entry must stay packed");
+
+    const Entry* locate(const Fingerprint& fp) const;
+    Entry* locate(const Fingerprint& fp);
+
+    // Cambios del índice; se aplican igual al confirmar una subida y al reproducir el log
+    void apply_container(uint32_t index, const std::string& id);
+    void apply_add(const Entry& entry);
+    void apply_ref(const Fingerprint& fp, uint32_t count);
+
+    void load();
+    void merge();
+    void compact();
+
+    Options options_;
+    std::string log_path_;
+    std::string snapshot_path_;
+
+    mutable std::shared_mutex mutex_;
+    std::vector<Entry> sorted_;
+    std::unordered_map<Fingerprint, Entry, FingerprintHash> recent_;
+    std::vector<std::string> containers_;
+    std::unordered_map<std::string, uint32_t> container_ids_;
+    uint64_t references_ = 0;
+    uint64_t stored_bytes_ = 0;
+
+    std::mutex log_mutex_; // una subida confirma a la vez
+    int log_fd_ = -1;
+    uint64_t log_bytes_ = 0;
+    bool failed_ = false;
+    uint64_t commit_seq_ = 0; // subidas confirmadas; el snapshot guarda la última incluida
+};
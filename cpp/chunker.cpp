@@ -0,0 +1,123 @@
+#include "chunker.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Tabla gear: 256 valores pseudoaleatorios fijos (splitmix64), iguales en cada ejecución
+constexpr std::array<uint64_t, 256> make_gear() {
+    std::array<uint64_t, 256> table{};
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (auto& value : table) {
+        state += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        value = z ^ (z >> 31);
+    }
+    return table;
+}
+
+constexpr std::array<uint64_t, 256> GEAR = make_gear();
+
+// Máscara con los bits más altos: dependen de los últimos 64 bytes, no solo de los últimos
+uint64_t top_bits(unsigned bits) {
+    return ~0ULL << (64 - bits);
+}
+
+uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xFF51AFD7ED558CCDULL;
+    k ^= k >> 33;
+    k *= 0xC4CEB9FE1A85EC53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+} // namespace
+
+Fingerprint fingerprint(const uint8_t* data, size_t len) {
+    const uint64_t c1 = 0x87C37B91114253D5ULL;
+    const uint64_t c2 = 0x4CF5AD432745937FULL;
+    uint64_t h1 = 0, h2 = 0;
+
+    size_t blocks = len / 16;
+    for (size_t i = 0; i < blocks; i++) {
+        uint64_t k1, k2;
+        std::memcpy(&k1, data + i * 16, 8);
+        std::memcpy(&k2, data + i * 16 + 8, 8);
+
+        k1 *= c1; k1 = std::rotl(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = std::rotl(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52DCE729;
+        k2 *= c2; k2 = std::rotl(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = std::rotl(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495AB5;
+    }
+
+    const uint8_t* tail = data + blocks * 16;
+    uint64_t k1 = 0, k2 = 0;
+    switch (len & 15) {
+        case 15: k2 ^= static_cast<uint64_t>(tail[14]) << 48; [[fallthrough]];
+        case 14: k2 ^= static_cast<uint64_t>(tail[13]) << 40; [[fallthrough]];
+        case 13: k2 ^= static_cast<uint64_t>(tail[12]) << 32; [[fallthrough]];
+        case 12: k2 ^= static_cast<uint64_t>(tail[11]) << 24; [[fallthrough]];
+        case 11: k2 ^= static_cast<uint64_t>(tail[10]) << 16; [[fallthrough]];
+        case 10: k2 ^= static_cast<uint64_t>(tail[9]) << 8; [[fallthrough]];
+        case 9:  k2 ^= static_cast<uint64_t>(tail[8]);
+                 k2 *= c2; k2 = std::rotl(k2, 33); k2 *= c1; h2 ^= k2; [[fallthrough]];
+        case 8:  k1 ^= static_cast<uint64_t>(tail[7]) << 56; [[fallthrough]];
+        case 7:  k1 ^= static_cast<uint64_t>(tail[6]) << 48; [[fallthrough]];
+        case 6:  k1 ^= static_cast<uint64_t>(tail[5]) << 40; [[fallthrough]];
+        case 5:  k1 ^= static_cast<uint64_t>(tail[4]) << 32; [[fallthrough]];
+        case 4:  k1 ^= static_cast<uint64_t>(tail[3]) << 24; [[fallthrough]];
+        case 3:  k1 ^= static_cast<uint64_t>(tail[2]) << 16; [[fallthrough]];
+        case 2:  k1 ^= static_cast<uint64_t>(tail[1]) << 8; [[fallthrough]];
+        case 1:  k1 ^= static_cast<uint64_t>(tail[0]);
+                 k1 *= c1; k1 = std::rotl(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= len;
+    h2 ^= len;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    Fingerprint fp;
+    fp.words[0] = static_cast<uint32_t>(h1 >> 32);
+    fp.words[1] = static_cast<uint32_t>(h1);
+    fp.words[2] = static_cast<uint32_t>(h2 >> 32);
+    return fp;
+}
+
+Chunker::Chunker(size_t avg_size) : min_(avg_size / 4), avg_(avg_size), max_(avg_size * 8) {
+    if (!std::has_single_bit(avg_size) || avg_size < 1024) {
+        throw std::runtime_error("Chunk average size must be a power of two of at least 1 KiB");
+    }
+    unsigned bits = std::countr_zero(avg_size);
+    mask_small_ = top_bits(bits + 2);
+    mask_large_ = top_bits(bits - 2);
+    chunk_.reserve(max_);
+}
+
+size_t Chunker::find_cut(const uint8_t* data, size_t len, bool& found) {
+    found = false;
+    size_t size = chunk_.size();
+    // Antes del mínimo no hay cortes: se saltan esos bytes sin calcular el hash
+    size_t i = size < min_ ? std::min(len, min_ - size) : 0;
+    for (; i < len; i++) {
+        hash_ = (hash_ << 1) + GEAR[data[i]];
+        size_t length = size + i + 1;
+        uint64_t mask = length < avg_ ? mask_small_ : mask_large_;
+        if ((hash_ & mask) == 0 || length >= max_) {
+            found = true;
+            hash_ = 0;
+            return i + 1;
+        }
+    }
+    return len;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Huella de 96 bits de un chunk (probabilidad de colisión despreciable para miles de millones)
+struct Fingerprint {
+    uint32_t words[3] = {0, 0, 0};
+
+    auto operator<=>(const Fingerprint&) const = default;
+};
+
+struct FingerprintHash {
+    size_t operator()(const Fingerprint& fp) const {
+        return (static_cast<uint64_t>(fp.words[0]) << 32) | fp.words[1];
+    }
+};
+
+// MurmurHash3 x64-128 truncado a 96 bits
+Fingerprint fingerprint(const uint8_t* data, size_t len);
+
+// Corte por contenido estilo FastCDC: hash "gear" rodante, sin evaluar cortes antes del mínimo
+// y con chunking normalizado (máscara más estricta antes del tamaño promedio y más laxa
+// después) para que los tamaños se concentren alrededor de avg_size. Como los cortes dependen
+// solo de los últimos 64 bytes, insertar datos en un archivo solo cambia los chunks vecinos.
+class Chunker {
+public:
+    // avg_size debe ser potencia de dos; mínimo avg/4 y máximo avg*8
+    explicit Chunker(size_t avg_size);
+
+    size_t min_size() const { return min_; }
+    size_t max_size() const { return max_; }
+
+    // Llama a emit(data, len) por cada chunk completo; guarda el resto para la próxima llamada
+    template <class Emit>
+    void feed(const uint8_t* data, size_t len, Emit emit) {
+        while (len > 0) {
+            bool found;
+            size_t n = find_cut(data, len, found);
+            if (found && chunk_.empty()) {
+                emit(data, n); // el chunk entero está en este bloque: sin copiarlo
+            } else {
+                chunk_.insert(chunk_.end(), data, data + n);
+                if (found) {
+                    emit(chunk_.data(), chunk_.size());
+                    chunk_.clear();
+                }
+            }
+            data += n;
+            len -= n;
+        }
+    }
+
+    // Emite el último chunk (más corto que el mínimo si el archivo termina ahí)
+    template <class Emit>
+    void finish(Emit emit) {
+        if (!chunk_.empty()) emit(chunk_.data(), chunk_.size());
+        chunk_.clear();
+        hash_ = 0;
+    }
+
+private:
+    // Bytes de data que pertenecen al chunk actual; found indica si ahí termina
+    size_t find_cut(const uint8_t* data, size_t len, bool& found);
+
+    size_t min_, avg_, max_;
+    uint64_t mask_small_, mask_large_;
+    uint64_t hash_ = 0;
+    std::vector<uint8_t> chunk_;
+};
@@ -0,0 +1,165 @@
+#include "compression.hpp"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5; // el bloque termina con al menos 5 literales
+constexpr size_t MF_LIMIT = 12;     // ninguna coincidencia empieza en los últimos 12 bytes
+constexpr size_t MAX_OFFSET = 65535;
+constexpr unsigned HASH_BITS = 12;
+
+constexpr size_t SAMPLE_SIZE = 4096;
+constexpr size_t SAMPLES = 4;
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+uint32_t hash4(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Escribe una longitud que no cupo en el nibble del token (bytes de 255 + resto)
+bool write_length(uint8_t*& op, const uint8_t* end, size_t len) {
+    while (len >= 255) {
+        if (op == end) return false;
+        *op++ = 255;
+        len -= 255;
+    }
+    if (op == end) return false;
+    *op++ = static_cast<uint8_t>(len);
+    return true;
+}
+
+bool read_length(const uint8_t*& ip, const uint8_t* end, size_t& len) {
+    uint8_t b;
+    do {
+        if (ip == end) return false;
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+// Secuencia: token, literales y (si match_len > 0) desplazamiento y largo de la coincidencia
+bool emit(uint8_t*& op, const uint8_t* end, const uint8_t* literals, size_t literal_len,
+          size_t offset, size_t match_len) {
+    if (op == end) return false;
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>(std::min<size_t>(literal_len, 15) << 4);
+    if (literal_len >= 15 && !write_length(op, end, literal_len - 15)) return false;
+    if (static_cast<size_t>(end - op) < literal_len) return false;
+    std::memcpy(op, literals, literal_len);
+    op += literal_len;
+    if (match_len == 0) return true;
+
+    if (end - op < 2) return false;
+    *op++ = static_cast<uint8_t>(offset);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    size_t extra = match_len - MIN_MATCH;
+    *token |= static_cast<uint8_t>(std::min<size_t>(extra, 15));
+    return extra < 15 || write_length(op, end, extra - 15);
+}
+
+} // namespace
+
+size_t lz4_bound(size_t len) {
+    return len + len / 255 + 16;
+}
+
+size_t lz4_compress(const uint8_t* src, size_t len, uint8_t* dst, size_t capacity) {
+    if (len >= (uint64_t{1} << 32)) return 0;
+    uint8_t* op = dst;
+    const uint8_t* end = dst + capacity;
+    size_t anchor = 0;
+
+    if (len > MF_LIMIT) {
+        uint32_t table[1u << HASH_BITS];
+        std::fill(std::begin(table), std::end(table), UINT32_MAX);
+        size_t limit = len - MF_LIMIT;
+        size_t ip = 0;
+        size_t misses = 0;
+        while (ip < limit) {
+            uint32_t sequence = read32(src + ip);
+            uint32_t& slot = table[hash4(sequence)];
+            size_t candidate = slot;
+            slot = static_cast<uint32_t>(ip);
+            if (candidate == UINT32_MAX || ip - candidate > MAX_OFFSET || read32(src + candidate) != sequence) {
+                ip += 1 + (misses++ >> 6); // en datos sin repeticiones se avanza cada vez más rápido
+                continue;
+            }
+            misses = 0;
+
+            size_t match_len = MIN_MATCH;
+            size_t max_len = len - LAST_LITERALS - ip;
+            while (match_len < max_len && src[candidate + match_len] == src[ip + match_len]) match_len++;
+
+            if (!emit(op, end, src + anchor, ip - anchor, ip - candidate, match_len)) return 0;
+            ip += match_len;
+            anchor = ip;
+        }
+    }
+    if (!emit(op, end, src + anchor, len - anchor, 0, 0)) return 0;
+    return op - dst;
+}
+
+bool lz4_decompress(const uint8_t* src, size_t len, uint8_t* dst, size_t dst_len) {
+    const uint8_t* ip = src;
+    const uint8_t* in_end = src + len;
+    uint8_t* op = dst;
+    uint8_t* out_end = dst + dst_len;
+
+    while (ip < in_end) {
+        uint8_t token = *ip++;
+        size_t literal_len = token >> 4;
+        if (literal_len == 15 && !read_length(ip, in_end, literal_len)) return false;
+        if (static_cast<size_t>(in_end - ip) < literal_len || static_cast<size_t>(out_end - op) < literal_len) {
+            return false;
+        }
+        std::memcpy(op, ip, literal_len);
+        ip += literal_len;
+        op += literal_len;
+        if (ip == in_end) break; // la última secuencia solo tiene literales
+
+        if (in_end - ip < 2) return false;
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst)) return false;
+        size_t match_len = token & 15;
+        if (match_len == 15 && !read_length(ip, in_end, match_len)) return false;
+        match_len += MIN_MATCH;
+        if (static_cast<size_t>(out_end - op) < match_len) return false;
+
+        // La coincidencia puede solaparse con lo que se está escribiendo (repeticiones cortas)
+        const uint8_t* match = op - offset;
+        if (offset >= match_len) {
+            std::memcpy(op, match, match_len);
+            op += match_len;
+        } else {
+            for (size_t i = 0; i < match_len; i++) *op++ = match[i];
+        }
+    }
+    return op == out_end;
+}
+
+bool worth_compressing(const uint8_t* data, size_t len) {
+    if (len <= SAMPLES * SAMPLE_SIZE) {
+        std::vector<uint8_t> out(lz4_bound(len));
+        size_t n = lz4_compress(data, len, out.data(), out.size());
+        return n > 0 && n < len - len / 10;
+    }
+    // Muestras repartidas a lo largo de la franja; se comprime si ahorran más del 10%
+    std::vector<uint8_t> out(lz4_bound(SAMPLE_SIZE));
+    size_t compressed = 0;
+    for (size_t i = 0; i < SAMPLES; i++) {
+        size_t at = (len - SAMPLE_SIZE) * i / (SAMPLES - 1);
+        size_t n = lz4_compress(data + at, SAMPLE_SIZE, out.data(), out.size());
+        compressed += n ? n : SAMPLE_SIZE;
+    }
+    return compressed < SAMPLES * SAMPLE_SIZE - SAMPLES * SAMPLE_SIZE / 10;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Compresión LZ4 (formato de bloque estándar, compatible con LZ4_decompress_safe) para
+// comprimir cada franja antes de codificarla. Prioriza velocidad: búsqueda voraz con una
+// tabla hash de 4096 posiciones.
+
+// Tamaño máximo del resultado de comprimir len bytes
+size_t lz4_bound(size_t len);
+
+// Devuelve el tamaño comprimido, o 0 si no cabe en capacity o len no es menor que 4 GiB
+// (las posiciones se guardan en 32 bits)
+size_t lz4_compress(const uint8_t* src, size_t len, uint8_t* dst, size_t capacity);
+
+// Devuelve false si el bloque está dañado o no descomprime exactamente a dst_len bytes
+bool lz4_decompress(const uint8_t* src, size_t len, uint8_t* dst, size_t dst_len);
+
+// Comprime unas muestras de data y decide si vale la pena comprimir todo
+// (los datos ya comprimidos, como imágenes o streams de PDF, se guardan tal cual)
+bool worth_compressing(const uint8_t* data, size_t len);
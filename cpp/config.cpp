@@ -0,0 +1,107 @@
+#include "config.hpp"
+#include "json.hpp"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+ControllerConfig load_config(const std::string& path) {
+    ControllerConfig config;
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Config " << path << " not found, using defaults\n";
+        return config;
+    }
+
+    json j = json::parse(in);
+    config.codec = j.value("codec", config.codec);
+    config.data_blocks = j.value("data_blocks", config.data_blocks);
+    config.parity_blocks = j.value("parity_blocks", config.parity_blocks);
+    config.placement = j.value("placement", config.placement);
+    config.stripe_unit = j.value("stripe_unit", config.stripe_unit);
+    config.transport = j.value("transport", config.transport);
+    config.io_threads = j.value("io_threads", config.io_threads);
+    config.hedge_percentile = j.value("hedge_percentile", config.hedge_percentile);
+    config.hedge_min_delay_ms = j.value("hedge_min_delay_ms", config.hedge_min_delay_ms);
+    config.connect_timeout_ms = j.value("connect_timeout_ms", config.connect_timeout_ms);
+    config.node_timeout_ms = j.value("node_timeout_ms", config.node_timeout_ms);
+    config.max_connections_per_node = j.value("max_connections_per_node", config.max_connections_per_node);
+    config.idle_timeout_ms = j.value("idle_timeout_ms", config.idle_timeout_ms);
+    config.health_interval_ms = j.value("health_interval_ms", config.health_interval_ms);
+    config.health_timeout_ms = j.value("health_timeout_ms", config.health_timeout_ms);
+    config.health_down_after = j.value("health_down_after", config.health_down_after);
+    config.health_up_after = j.value("health_up_after", config.health_up_after);
+    config.dedup = j.value("dedup", config.dedup);
+    config.chunk_avg_size = j.value("chunk_avg_size", config.chunk_avg_size);
+    config.compression = j.value("compression", config.compression);
+    config.rebuild_parallelism = j.value("rebuild_parallelism", config.rebuild_parallelism);
+    config.rebuild_bandwidth_mb = j.value("rebuild_bandwidth_mb", config.rebuild_bandwidth_mb);
+    config.rebalance_parallelism = j.value("rebalance_parallelism", config.rebalance_parallelism);
+    config.rebalance_bandwidth_mb = j.value("rebalance_bandwidth_mb", config.rebalance_bandwidth_mb);
+    config.scrub_interval_hours = j.value("scrub_interval_hours", config.scrub_interval_hours);
+    config.scrub_bandwidth_mb = j.value("scrub_bandwidth_mb", config.scrub_bandwidth_mb);
+    config.scrub_repair = j.value("scrub_repair", config.scrub_repair);
+    config.stripe_cache_mb = j.value("stripe_cache_mb", config.stripe_cache_mb);
+    config.metadata_dir = j.value("metadata_dir", config.metadata_dir);
+    config.metadata_compact_bytes = j.value("metadata_compact_bytes", config.metadata_compact_bytes);
+    if (j.contains("nodes")) {
+        config.nodes.clear();
+        config.node_weights.clear();
+        for (const auto& node : j.at("nodes")) {
+            if (node.is_string()) {
+                config.nodes.push_back(node.get<std::string>());
+                config.node_weights.push_back(1.0);
+            } else {
+                config.nodes.push_back(node.at("url").get<std::string>());
+                config.node_weights.push_back(node.value("weight", 1.0));
+            }
+        }
+    }
+    config.node_config_dir = j.value("node_config_dir", config.node_config_dir);
+    config.node_config_reload_ms = j.value("node_config_reload_ms", config.node_config_reload_ms);
+    config.port = j.value("port", config.port);
+    config.instance_id = j.value("instance_id", config.instance_id);
+
+    if (config.hedge_percentile <= 0 || config.hedge_percentile > 100) {
+        throw std::runtime_error("hedge_percentile must be in (0, 100]");
+    }
+    if (config.instance_id < 0 || config.instance_id > 1023) {
+        throw std::runtime_error("instance_id must be between 0 and 1023");
+    }
+    if (config.io_threads == 0) throw std::runtime_error("io_threads must be positive");
+    if (config.max_connections_per_node == 0) throw std::runtime_error("max_connections_per_node must be positive");
+    if (config.health_interval_ms < 0) throw std::runtime_error("health_interval_ms must not be negative");
+    if (config.health_timeout_ms <= 0) throw std::runtime_error("health_timeout_ms must be positive");
+    if (config.health_down_after == 0 || config.health_up_after == 0) {
+        throw std::runtime_error("health_down_after and health_up_after must be positive");
+    }
+    if (config.rebuild_parallelism == 0) throw std::runtime_error("rebuild_parallelism must be positive");
+    if (config.rebuild_bandwidth_mb < 0) throw std::runtime_error("rebuild_bandwidth_mb must not be negative");
+    if (config.rebalance_parallelism == 0) throw std::runtime_error("rebalance_parallelism must be positive");
+    if (config.rebalance_bandwidth_mb < 0) throw std::runtime_error("rebalance_bandwidth_mb must not be negative");
+    if (config.node_config_reload_ms < 0) throw std::runtime_error("node_config_reload_ms must not be negative");
+    if (config.scrub_interval_hours < 0) throw std::runtime_error("scrub_interval_hours must not be negative");
+    if (config.scrub_bandwidth_mb < 0) throw std::runtime_error("scrub_bandwidth_mb must not be negative");
+    bool power_of_two = (config.chunk_avg_size & (config.chunk_avg_size - 1)) == 0;
+    if (!power_of_two || config.chunk_avg_size < 1024 || config.chunk_avg_size > 64 * 1024) {
+        throw std::runtime_error("chunk_avg_size must be a power of two between 1 KiB and 64 KiB");
+    }
+    if (config.placement != "hashed" && config.placement != "rotating" && config.placement != "fixed") {
+        throw std::runtime_error("placement must be \"hashed\", \"rotating\" or \"fixed\"");
+    }
+    for (double weight : config.node_weights) {
+        if (weight < 0) throw std::runtime_error("Node weights must not be negative");
+    }
+    if (config.compression != "lz4" && config.compression != "none") {
+        throw std::runtime_error("compression must be \"lz4\" or \"none\"");
+    }
+    if (config.stripe_unit < 4 * 1024 || config.stripe_unit > 64 * 1024 * 1024) {
+        throw std::runtime_error("stripe_unit must be between 4 KiB and 64 MiB");
+    }
+    // La compresión guarda posiciones de 32 bits dentro de la franja
+    if (config.stripe_unit * config.data_blocks >= (uint64_t{1} << 32)) {
+        throw std::runtime_error("stripe_unit * data_blocks must be less than 4 GiB");
+    }
+    return config;
+}
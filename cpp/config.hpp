@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Configuración del controlador (controller_config.json); los valores por defecto
+// reproducen el esquema original: 3 bloques de datos + 1 de paridad XOR en 4 nodos.
+struct ControllerConfig {
+    std::string codec = "xor";     // "xor" o "rs"
+    size_t data_blocks = 3;        // k
+    size_t parity_blocks = 1;      // m
+    // "hashed" (cada franja en k + m de todos los nodos, por hashing consistente), "rotating"
+    // (paridad en un nodo distinto por franja, en los primeros k + m nodos) o "fixed"
+    std::string placement = "hashed";
+    size_t stripe_unit = 256 * 1024; // bytes por unidad de franja
+    std::string transport = "binary"; // "binary" (octet-stream) o "json" (compatibilidad)
+    size_t io_threads = 16;        // hilos para la E/S en paralelo con los nodos
+    double hedge_percentile = 95;  // pide paridad si las lecturas superan este percentil de latencia
+    double hedge_min_delay_ms = 10; // espera mínima antes de cubrir una lectura lenta
+    int connect_timeout_ms = 2000; // conexión con un Disk Node
+    int node_timeout_ms = 30000;   // lectura/escritura de un bloque
+    size_t max_connections_per_node = 8; // conexiones keep-alive abiertas por Disk Node
+    int idle_timeout_ms = 4000;    // cierra las conexiones inactivas por más tiempo
+    int health_interval_ms = 500;  // entre sondeos de GET /status a cada nodo (0: sin sondeos)
+    int health_timeout_ms = 300;   // un sondeo más lento cuenta como fallido
+    size_t health_down_after = 3;  // sondeos fallidos seguidos para dejar de usar un nodo
+    size_t health_up_after = 2;    // sondeos correctos seguidos para volver a usarlo
+    bool dedup = true;             // guarda una sola vez los chunks repetidos entre subidas
+    size_t chunk_avg_size = 8192;  // tamaño promedio de chunk (potencia de dos, 1-64 KiB)
+    std::string compression = "lz4"; // "lz4" (cada franja cuya muestra comprima) o "none"
+    size_t rebuild_parallelism = 4;  // franjas que se reconstruyen a la vez al reponer un nodo
+    double rebuild_bandwidth_mb = 64; // MB/s que puede usar la reconstrucción (0: sin límite)
+    size_t rebalance_parallelism = 2; // archivos que se mudan a la vez al cambiar los nodos
+    double rebalance_bandwidth_mb = 32; // MB/s que puede usar el rebalanceo (0: sin límite)
+    double scrub_interval_hours = 24; // entre pasadas de verificación de paridad (0: solo a pedido)
+    double scrub_bandwidth_mb = 16;  // MB/s que puede usar la verificación (0: sin límite)
+    bool scrub_repair = true;        // reescribe las unidades inconsistentes que se puedan decodificar
+    size_t stripe_cache_mb = 256;    // franjas reconstruidas que se guardan en memoria (0: sin caché)
+    std::string metadata_dir = "storage/controller"; // índice persistente de archivos
+    size_t metadata_compact_bytes = 4 * 1024 * 1024; // tamaño del log que dispara un snapshot
+    std::vector<std::string> nodes = {
+        "http://127.0.0.1:5001",
+        "http://127.0.0.1:5002",
+        "http://127.0.0.1:5003",
+        "http://127.0.0.1:5004"
+    };
+    // Parte de las franjas nuevas que recibe cada nodo con "hashed", relativa al resto (0: ninguna).
+    // En el JSON un nodo puede ser la URL o {"url": ..., "weight": ...}; el peso por defecto es 1.
+    std::vector<double> node_weights = std::vector<double>(4, 1.0);
+    // XML de los Disk Nodes (python/generate_xml.py); si hay alguno reemplazan a nodes, con su
+    // peso y capacidad. Se vuelven a leer cada node_config_reload_ms (0: solo al arrancar).
+    std::string node_config_dir = "disk_config";
+    int node_config_reload_ms = 2000;
+    int port = 8080;
+    int instance_id = 0;           // distinto en cada controlador que comparta los nodos (0-1023)
+};
+
+// Si el archivo no existe se usan los valores por defecto; un JSON inválido lanza excepción
+ControllerConfig load_config(const std::string& path);
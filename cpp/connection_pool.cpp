@@ -0,0 +1,116 @@
+#include "connection_pool.hpp"
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), node_(other.node_), client_(std::move(other.client_)), healthy_(other.healthy_) {
+    other.pool_ = nullptr;
+}
+
+ConnectionPool::Lease& ConnectionPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        node_ = other.node_;
+        client_ = std::move(other.client_);
+        healthy_ = other.healthy_;
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+ConnectionPool::Lease::~Lease() {
+    release();
+}
+
+void ConnectionPool::Lease::release() {
+    if (pool_ && client_) pool_->give_back(node_, std::move(client_), healthy_);
+    pool_ = nullptr;
+}
+
+ConnectionPool::ConnectionPool(std::vector<std::string> urls, Options options)
+    : options_(options), nodes_(urls.size()) {
+    for (size_t i = 0; i < urls.size(); i++) nodes_[i].url = std::move(urls[i]);
+}
+
+std::unique_ptr<httplib::Client> ConnectionPool::connect(const std::string& url) const {
+    auto client = std::make_unique<httplib::Client>(url);
+    client->set_keep_alive(true);
+    client->set_connection_timeout(std::chrono::milliseconds(options_.connect_timeout_ms));
+    client->set_read_timeout(std::chrono::milliseconds(options_.io_timeout_ms));
+    client->set_write_timeout(std::chrono::milliseconds(options_.io_timeout_ms));
+    return client;
+}
+
+ConnectionPool::Lease ConnectionPool::acquire(size_t node) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Node& slot = nodes_[node];
+
+    // Descarta las conexiones que el servidor probablemente ya cerró
+    auto now = Clock::now();
+    auto max_idle = std::chrono::milliseconds(options_.idle_timeout_ms);
+    while (!slot.idle.empty() && now - slot.idle.front().since > max_idle) {
+        slot.idle.pop_front();
+        slot.open--;
+        evictions_++;
+    }
+
+    bool ready = available_.wait_for(lock, std::chrono::milliseconds(options_.acquire_timeout_ms), [&] {
+        return !slot.idle.empty() || slot.open < options_.max_per_node;
+    });
+    if (!ready) {
+        timeouts_++;
+        return Lease();
+    }
+
+    if (!slot.idle.empty()) {
+        auto client = std::move(slot.idle.back().client);
+        slot.idle.pop_back();
+        hits_++;
+        return Lease(this, node, std::move(client));
+    }
+    slot.open++;
+    misses_++;
+    std::string url = slot.url;
+    lock.unlock();
+    return Lease(this, node, connect(url));
+}
+
+void ConnectionPool::give_back(size_t node, std::unique_ptr<httplib::Client> client, bool healthy) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Node& slot = nodes_[node];
+        if (healthy) {
+            slot.idle.push_back({std::move(client), Clock::now()});
+        } else {
+            // El nodo no respondió: sus otras conexiones inactivas tampoco son confiables
+            evictions_ += 1 + slot.idle.size();
+            slot.open -= 1 + slot.idle.size();
+            slot.idle.clear();
+        }
+    }
+    available_.notify_all();
+}
+
+size_t ConnectionPool::add_node(std::string url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nodes_.emplace_back().url = std::move(url);
+    return nodes_.size() - 1;
+}
+
+size_t ConnectionPool::node_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nodes_.size();
+}
+
+ConnectionPool::Stats ConnectionPool::stats() const {
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.timeouts = timeouts_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& node : nodes_) {
+        stats.open.push_back(node.open);
+        stats.idle.push_back(node.idle.size());
+    }
+    return stats;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "httplib.h"
+
+// Conexiones keep-alive reutilizables hacia cada Disk Node, compartidas por todos los
+// hilos del servidor. Cada nodo tiene un máximo de conexiones abiertas; una conexión que
+// falla se descarta junto con las inactivas de ese nodo (probablemente también rotas).
+class ConnectionPool {
+public:
+    struct Options {
+        size_t max_per_node = 8;
+        int idle_timeout_ms = 4000;    // menor que el keep-alive del servidor (5 s en httplib)
+        int acquire_timeout_ms = 2000; // espera máxima por una conexión libre
+        int connect_timeout_ms = 2000;
+        int io_timeout_ms = 30000;
+    };
+
+    // Préstamo de una conexión; al destruirse vuelve al pool salvo que se marque como fallida
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        explicit operator bool() const { return client_ != nullptr; }
+        httplib::Client& operator*() { return *client_; }
+        httplib::Client* operator->() { return client_.get(); }
+
+        // La conexión no respondió: se cierra en vez de reutilizarse
+        void fail() { healthy_ = false; }
+
+    private:
+        friend class ConnectionPool;
+        Lease(ConnectionPool* pool, size_t node, std::unique_ptr<httplib::Client> client)
+            : pool_(pool), node_(node), client_(std::move(client)) {}
+        void release();
+
+        ConnectionPool* pool_ = nullptr;
+        size_t node_ = 0;
+        std::unique_ptr<httplib::Client> client_;
+        bool healthy_ = true;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;      // se reutilizó una conexión abierta
+        uint64_t misses = 0;    // hubo que crear una conexión nueva
+        uint64_t evictions = 0; // conexiones descartadas por fallo o inactividad
+        uint64_t timeouts = 0;  // no hubo conexión libre a tiempo
+        std::vector<size_t> open;  // conexiones abiertas por nodo
+        std::vector<size_t> idle;  // de ellas, inactivas en el pool
+    };
+
+    ConnectionPool(std::vector<std::string> urls, Options options);
+
+    // Devuelve un préstamo vacío si el nodo ya tiene max_per_node conexiones ocupadas
+    // durante acquire_timeout_ms
+    Lease acquire(size_t node);
+
+    // Agrega un nodo al final (los índices existentes no cambian) y devuelve su índice
+    size_t add_node(std::string url);
+
+    Stats stats() const;
+    size_t node_count() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct IdleConnection {
+        std::unique_ptr<httplib::Client> client;
+        Clock::time_point since;
+    };
+
+    struct Node {
+        std::string url;
+        std::deque<IdleConnection> idle; // la más reciente al final
+        size_t open = 0;
+    };
+
+    std::unique_ptr<httplib::Client> connect(const std::string& url) const;
+    void give_back(size_t node, std::unique_ptr<httplib::Client> client, bool healthy);
+
+    Options options_;
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::deque<Node> nodes_; // deque: agregar un nodo no mueve los demás (acquire los referencia)
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> timeouts_{0};
+};
@@ -1,5 +1,14 @@
 #include <iostream>
 #include <vector>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <unordered_map>
 #include "httplib.h"
 #include <fstream>
@@ -7,6 +16,28 @@
 #include <filesystem>
 #include "json.hpp"
 #include "blocks.hpp"
+#include "parity.hpp"
+#include "erasure.hpp"
+#include "gf256.hpp"
+#include "config.hpp"
+#include "stripe.hpp"
+#include "node_client.hpp"
+#include "node_health.hpp"
+#include "connection_pool.hpp"
+#include "metadata_store.hpp"
+#include "node_ring.hpp"
+#include "file_id.hpp"
+#include "chunker.hpp"
+#include "chunk_index.hpp"
+#include "compression.hpp"
+#include "crc32c.hpp"
+#include "durable_file.hpp"
+#include "io_pool.hpp"
+#include "latency.hpp"
+#include "patch_journal.hpp"
+#include "rate_limiter.hpp"
+#include "stripe_cache.hpp"
+#include "topology.hpp"
 
 namespace fs = std::filesystem;
 using namespace httplib;
@@ -14,146 +45,1992 @@ using json = nlohmann::json;
 using ByteBlock = std::vector<uint8_t>; // Array de longitud variable con datos binarios
 using Blocks = std::vector<ByteBlock>; // Conjunto de ByteBlocks
 
-const std::vector<std::string> DISK_NODES = {
-    "http://127.0.0.1:5001", // 3 nodos para datos
-    "http://127.0.0.1:5002",
-    "http://127.0.0.1:5003",
-    "http://127.0.0.1:5004" // 1 nodo para paridad
+ControllerConfig CONFIG; // nodos, k y m (controller_config.json)
+std::shared_ptr<ErasureCodec> CODEC; // xor o rs según la configuración
+Transport TRANSPORT = Transport::Binary; // formato de los bloques hacia los nodos
+std::unique_ptr<IoPool> IO_POOL; // hilos para enviar/recibir bloques en paralelo
+std::unique_ptr<ConnectionPool> NODE_POOL; // conexiones keep-alive hacia los Disk Nodes
+std::atomic<std::shared_ptr<const Topology>> TOPOLOGY; // nodos actuales y su anillo (topology.hpp)
+std::mutex TOPOLOGY_MUTEX; // ordena los cambios de topología (lecturas sin candado)
+std::unique_ptr<NodeHealth> NODE_HEALTH; // estado de cada nodo según los sondeos (nulo sin sondeos)
+std::atomic<uint64_t> DOWN_NODE_SKIPS{0}; // operaciones que no se intentaron por estar el nodo caído
+LatencyTracker READ_LATENCY; // latencias recientes de /retrieve, para decidir cuándo cubrir
+std::atomic<uint64_t> HEDGED_READS{0}; // franjas en las que se pidió paridad por lentitud
+std::atomic<uint64_t> DEGRADED_STRIPES{0}; // franjas decodificadas desde paridad
+std::atomic<uint64_t> CORRUPT_UNITS{0}; // unidades leídas con CRC32C incorrecto (reparadas con paridad)
+
+// distribución y codec de cada archivo, persistente entre reinicios
+std::unique_ptr<MetadataStore> METADATA;
+std::unique_ptr<FileIdGenerator> FILE_IDS; // ids únicos aunque lleguen muchas subidas por segundo
+std::unique_ptr<ChunkIndex> CHUNKS; // huellas de los chunks ya guardados (nulo sin deduplicación)
+std::atomic<uint64_t> DEDUP_SAVED_BYTES{0}; // bytes subidos que no se guardaron por estar repetidos
+std::atomic<uint64_t> COMPRESSED_STRIPES{0}; // franjas guardadas comprimidas
+std::atomic<uint64_t> COMPRESSION_SAVED_BYTES{0}; // bytes de datos que la compresión no envió
+std::unique_ptr<PatchJournal> PATCH_JOURNAL; // franjas de escrituras en sitio aún no aplicadas
+std::atomic<uint64_t> PATCHED_STRIPES{0}; // franjas actualizadas con escrituras en sitio
+std::atomic<uint64_t> PATCH_FALLBACKS{0}; // de ellas, las que se recodificaron completas
+std::atomic<uint64_t> PATCH_NODE_BYTES{0}; // bytes leídos y escritos en los nodos por esas escrituras
+std::unique_ptr<StripeCache> STRIPE_CACHE; // franjas reconstruidas más pedidas (nula si está desactivada)
+
+std::shared_ptr<const Topology> topology() {
+    return TOPOLOGY.load();
+}
+
+// Candados por archivo (repartidos por hash) que ordenan las escrituras en sitio entre sí y
+// con la reconstrucción, el scrub y el rebalanceo, que si no verían franjas a medio actualizar.
+// Las descargas los toman compartidos, así no se frenan entre ellas.
+std::array<std::shared_mutex, 64> FILE_LOCKS;
+using FileLock = std::unique_lock<std::shared_mutex>;
+using SharedFileLock = std::shared_lock<std::shared_mutex>;
+// Cambios de metadatos hechos con cada candado tomado (cada uno protegido por el suyo), para
+// saber sin copiar los metadatos si hay que recargarlos
+std::array<uint64_t, 64> FILE_VERSIONS{};
+
+size_t file_slot(const std::string& file_id) {
+    return std::hash<std::string>{}(file_id) % FILE_LOCKS.size();
+}
+
+std::shared_mutex& file_lock(const std::string& file_id) {
+    return FILE_LOCKS[file_slot(file_id)];
+}
+
+// Guarda los metadatos de un archivo cuyo candado ya se tomó
+void put_locked(const std::string& file_id, const FileMetadata& meta) {
+    METADATA->put(file_id, meta);
+    FILE_VERSIONS[file_slot(file_id)]++;
+}
+
+// Toma el candado del archivo mientras se procesa una de sus franjas y recarga sus metadatos si
+// cambiaron desde la última vez (los CRC32C cambian con cada escritura en sitio y el rebalanceo
+// muda franjas de nodo); solo hace falta en archivos updatable o repartidos con el anillo.
+// version guarda la versión de los metadatos cargados (empieza en UINT64_MAX: sin cargar). El
+// contador es del candado y no del archivo, así que un cambio en otro archivo que comparte el
+// candado solo cuesta una recarga de más. Con Lock = SharedFileLock el candado es compartido.
+template <class Lock = FileLock>
+Lock lock_stripe(const std::string& file_id, std::optional<FileMetadata>& meta, uint64_t& version) {
+    if (!meta->updatable && meta->layout.placement != Placement::Hashed) return {};
+    Lock lock(file_lock(file_id));
+    uint64_t current = FILE_VERSIONS[file_slot(file_id)];
+    if (current != version) {
+        meta = METADATA->get(file_id);
+        version = current;
+    }
+    return lock;
+}
+
+// Para lo que se prepara sin el candado con los metadatos que cargó lock_stripe: vuelve a tomar
+// el candado y devuelve true si los metadatos no cambiaron, así lo preparado se puede escribir
+// con el candado tomado. Si cambiaron los recarga, suelta el candado y devuelve false (hay que
+// prepararlo otra vez).
+bool confirm_stripe(const std::string& file_id, std::optional<FileMetadata>& meta, uint64_t& version,
+                    FileLock& lock) {
+    uint64_t prepared = version;
+    lock = lock_stripe(file_id, meta, version);
+    if (version == prepared) return true;
+    lock.unlock();
+    return false;
+}
+
+// Peticiones pendientes de cada nodo durante una descarga. Las lecturas de cobertura (hedged)
+// pueden terminar después de que la descarga siguió adelante, así que el contador es compartido
+// y sirve para no encolar más lecturas sobre un nodo que está lento.
+struct NodeLoad {
+    std::vector<std::atomic<int>> in_flight; // uno por nodo de la topología al empezar
+
+    explicit NodeLoad(size_t n) : in_flight(n) {}
+
+    // Un nodo registrado después de empezar cuenta siempre como libre
+    int pending(size_t node) const { return node < in_flight.size() ? in_flight[node].load() : 0; }
+    void add(size_t node, int delta) {
+        if (node < in_flight.size()) in_flight[node] += delta;
+    }
+};
+
+bool node_down(size_t node) {
+    return NODE_HEALTH && NODE_HEALTH->is_down(node);
+}
+
+// Ejecuta op con una conexión del pool hacia el nodo; si el nodo no respondió
+// la conexión se descarta en lugar de volver al pool. Con un nodo caído falla sin
+// contactarlo, así quien llama pasa a la paridad sin esperar el timeout de conexión.
+template <class Op>
+bool with_node(size_t node, Op op) {
+    if (node_down(node)) {
+        DOWN_NODE_SKIPS++;
+        return false;
+    }
+    auto client = NODE_POOL->acquire(node);
+    if (!client) {
+        std::cerr << "No free connection to " << topology()->nodes[node].url << "\n";
+        return false;
+    }
+    BlockStatus status = op(*client);
+    if (status == BlockStatus::Unreachable) client.fail();
+    return status == BlockStatus::Ok;
+}
+
+// Guarda una unidad en el nodo y la cuenta en sus escrituras
+bool store_unit(size_t node, const std::string& block_id, const uint8_t* data, size_t len) {
+    bool ok = with_node(node, [&](Client& client) { return store_block(client, block_id, data, len, TRANSPORT); });
+    if (ok) {
+        std::shared_ptr<NodeCounters> counters = topology()->counters[node];
+        counters->write_bytes += len;
+        counters->write_units++;
+    }
+    return ok;
+}
+
+// Borra una unidad que ya no está en los metadatos (registra el error si no se pudo)
+bool delete_unit(size_t node, const std::string& block_id) {
+    return with_node(node, [&](Client& client) { return delete_block(client, block_id); });
+}
+
+// Distribución para un archivo nuevo según la configuración actual
+StripeLayout new_layout(size_t file_size) {
+    StripeLayout layout;
+    layout.file_size = file_size;
+    layout.k = CODEC->data_blocks();
+    layout.m = CODEC->parity_blocks();
+    layout.stripe_unit = CONFIG.stripe_unit;
+    if (CONFIG.placement == "hashed") layout.placement = Placement::Hashed;
+    else if (CONFIG.placement == "rotating") layout.placement = Placement::Rotating;
+    else layout.placement = Placement::Fixed;
+    return layout;
+}
+
+// Codec con el que se guardó un archivo (normalmente el configurado actualmente)
+std::shared_ptr<const ErasureCodec> codec_for(const FileMetadata& meta) {
+    if (meta.codec == CODEC->name() && meta.layout.k == CODEC->data_blocks() &&
+        meta.layout.m == CODEC->parity_blocks()) {
+        return CODEC;
+    }
+    return make_codec(meta.codec, meta.layout.k, meta.layout.m);
+}
+
+// CRC32C de las k + m unidades de una franja; nulo en archivos guardados sin sumas de verificación
+const uint32_t* stripe_checksums(const FileMetadata& meta, size_t stripe) {
+    size_t n = meta.layout.k + meta.layout.m;
+    if (meta.checksums.size() != meta.layout.stripe_count() * n) return nullptr;
+    return meta.checksums.data() + stripe * n;
+}
+
+// Resultado agregado de escribir una franja en todos sus nodos
+struct StripeWriteResult {
+    std::vector<bool> stored; // una entrada por unidad (datos y paridad)
+    std::vector<uint32_t> checksums; // CRC32C de cada unidad
+
+    size_t stored_count() const { return std::count(stored.begin(), stored.end(), true); }
+};
+
+// Envía las k unidades de datos en paralelo, calcula las m paridades mientras viajan
+// y las envía también; espera a que todos los nodos respondan. Cada unidad va al nodo que le
+// asigna la distribución del archivo y su CRC32C se calcula en el mismo hilo que la envía.
+StripeWriteResult distribute_blocks(const std::vector<const uint8_t*>& blocks, size_t len,
+                                    const std::string& file_id, const StripeLayout& layout, size_t stripe) {
+    size_t k = CODEC->data_blocks();
+    size_t m = CODEC->parity_blocks();
+    if (blocks.size() != k) throw std::runtime_error("Expected " + std::to_string(k) + " data blocks");
+
+    StripeWriteResult result;
+    result.checksums.resize(k + m);
+    auto send = [&](size_t i, const uint8_t* unit) {
+        size_t node = layout.node(stripe, i);
+        return IO_POOL->submit([&file_id, &result, i, node, unit, len, stripe, k] {
+            result.checksums[i] = crc32c(unit, len);
+            return store_unit(node, unit_id(file_id, stripe, i, k), unit, len);
+        });
+    };
+
+    std::vector<std::future<bool>> pending;
+    for (size_t i = 0; i < k; i++) pending.push_back(send(i, blocks[i]));
+
+    Blocks parity(m, ByteBlock(len));
+    std::vector<uint8_t*> parity_ptrs;
+    for (auto& block : parity) parity_ptrs.push_back(block.data());
+    CODEC->encode(blocks.data(), parity_ptrs.data(), len);
+    for (size_t j = 0; j < m; j++) pending.push_back(send(k + j, parity[j].data()));
+
+    for (auto& write : pending) result.stored.push_back(write.get());
+    return result;
+}
+
+// Recibe el archivo por partes y codifica cada franja en cuanto se completa.
+// Solo se guarda una franja en memoria, sin importar el tamaño del archivo.
+// Con compresión, cada franja cuya muestra comprima se guarda como bloque LZ4 (si de verdad
+// ahorra espacio) y se reparte en unidades más cortas; las demás se guardan tal cual.
+class StripeUploader {
+public:
+    StripeUploader(std::string file_id, bool compress)
+        : file_id_(std::move(file_id)), layout_(new_layout(0)), topology_(topology()), compress_(compress) {
+        buffer_.resize(layout_.stripe_width());
+    }
+
+    void write(const char* data, size_t len) {
+        while (len > 0) {
+            size_t n = std::min(len, buffer_.size() - filled_);
+            std::memcpy(buffer_.data() + filled_, data, n);
+            filled_ += n;
+            data += n;
+            len -= n;
+            layout_.file_size += n;
+            if (filled_ == buffer_.size()) flush_stripe();
+        }
+    }
+
+    // Bytes recibidos hasta ahora
+    size_t size() const { return layout_.file_size; }
+
+    // Envía la última franja (incompleta) y devuelve la distribución final
+    StripeLayout finish() {
+        if (filled_ > 0) flush_stripe();
+        return layout_;
+    }
+
+    // CRC32C de cada unidad (k + m por franja) y de los datos de cada franja
+    const std::vector<uint32_t>& unit_checksums() const { return unit_checksums_; }
+    const std::vector<uint32_t>& stripe_checksums() const { return stripe_checksums_; }
+
+private:
+    void flush_stripe() {
+        // unidades de ceil(bytes guardados / k) bytes; el relleno se llena con ceros
+        size_t k = layout_.k;
+        stripe_checksums_.push_back(crc32c(buffer_.data(), filled_));
+        ByteBlock* payload = &buffer_;
+        StripeEncoding encoding{StripeCompression::None, filled_};
+        if (compress_) {
+            if (compress_stripe()) {
+                payload = &compressed_;
+                encoding = {StripeCompression::Lz4, compressed_len_};
+                COMPRESSED_STRIPES++;
+                COMPRESSION_SAVED_BYTES += filled_ - compressed_len_;
+            }
+            layout_.encodings.push_back(encoding);
+        }
+        size_t stored_len = encoding.stored_length;
+        size_t unit = (stored_len + k - 1) / k;
+        std::fill(payload->begin() + stored_len, payload->begin() + k * unit, 0);
+        std::vector<const uint8_t*> blocks;
+        for (size_t i = 0; i < k; i++) blocks.push_back(payload->data() + i * unit);
+        if (layout_.placement == Placement::Hashed) {
+            size_t n = k + layout_.m;
+            layout_.stripe_nodes.resize((stripe_ + 1) * n);
+            topology_->ring->place(file_id_, stripe_, layout_.stripe_nodes.data() + stripe_ * n);
+        }
+        StripeWriteResult result = distribute_blocks(blocks, unit, file_id_, layout_, stripe_);
+
+        // Con menos de k unidades guardadas la franja no se podría reconstruir
+        size_t stored = result.stored_count();
+        if (stored < k) {
+            throw std::runtime_error("Stripe " + std::to_string(stripe_) + " stored on only " +
+                                     std::to_string(stored) + " of " + std::to_string(result.stored.size()) + " nodes");
+        }
+        if (stored < result.stored.size()) {
+            std::cerr << "Stripe " << stripe_ << " of " << file_id_ << " written degraded ("
+                      << stored << "/" << result.stored.size() << " units)\n";
+        }
+        unit_checksums_.insert(unit_checksums_.end(), result.checksums.begin(), result.checksums.end());
+        stripe_++;
+        filled_ = 0;
+    }
+
+    // Comprime la franja en compressed_ si la muestra lo justifica y el resultado ahorra
+    // al menos 1/16 del tamaño; si no, la franja se guarda tal cual
+    bool compress_stripe() {
+        if (!worth_compressing(buffer_.data(), filled_)) return false;
+        // El relleno de la última unidad también tiene que caber (hasta k - 1 bytes)
+        compressed_.resize(lz4_bound(buffer_.size()) + layout_.k);
+        compressed_len_ = lz4_compress(buffer_.data(), filled_, compressed_.data(), compressed_.size() - layout_.k);
+        return compressed_len_ > 0 && compressed_len_ <= filled_ - filled_ / 16;
+    }
+
+    std::string file_id_;
+    StripeLayout layout_;
+    std::shared_ptr<const Topology> topology_; // la misma en toda la subida aunque se registre un nodo
+    bool compress_;
+    ByteBlock buffer_;
+    ByteBlock compressed_;
+    size_t compressed_len_ = 0;
+    size_t filled_ = 0;
+    size_t stripe_ = 0;
+    std::vector<uint32_t> unit_checksums_;
+    std::vector<uint32_t> stripe_checksums_;
+};
+
+// Subida con deduplicación: corta el archivo en chunks por contenido y solo escribe en las
+// franjas de este archivo (su contenedor) los chunks que no estaban guardados. El archivo
+// queda descrito por extents que apuntan a su contenedor o a los de subidas anteriores.
+// Un archivo updatable se guarda sin deduplicar ni comprimir, así cada byte tiene una posición
+// fija en sus franjas y nadie más apunta a ellas: se puede reescribir en sitio (PATCH /update).
+class FileUploader {
+public:
+    FileUploader(std::string file_id, bool updatable)
+        : file_id_(std::move(file_id)), updatable_(updatable),
+          stripes_(file_id_, !updatable && CONFIG.compression == "lz4"), chunker_(CONFIG.chunk_avg_size) {}
+
+    void write(const char* data, size_t len) {
+        if (!dedup()) {
+            stripes_.write(data, len);
+            return;
+        }
+        chunker_.feed(reinterpret_cast<const uint8_t*>(data), len,
+                      [this](const uint8_t* chunk, size_t n) { add_chunk(chunk, n); });
+    }
+
+    // Termina de escribir las franjas y devuelve los metadatos del archivo
+    FileMetadata finish() {
+        if (dedup()) chunker_.finish([this](const uint8_t* chunk, size_t n) { add_chunk(chunk, n); });
+        FileMetadata meta;
+        meta.layout = stripes_.finish();
+        meta.codec = CODEC->name();
+        meta.checksums = stripes_.unit_checksums();
+        meta.stripe_checksums = stripes_.stripe_checksums();
+        meta.extents = std::move(extents_);
+        meta.updatable = updatable_;
+        return meta;
+    }
+
+    // Publica los chunks nuevos para otras subidas; se llama con los metadatos ya guardados
+    // para que ninguna subida apunte a un contenedor que no se podría leer tras un reinicio
+    void commit() {
+        if (!dedup()) return;
+        std::vector<NewChunk> added;
+        added.reserve(local_.size());
+        for (const auto& [fp, chunk] : local_) added.push_back(chunk);
+        CHUNKS->commit(file_id_, added, referenced_);
+    }
+
+private:
+    bool dedup() const { return CHUNKS && !updatable_; }
+
+    void add_chunk(const uint8_t* data, size_t len) {
+        Fingerprint fp = fingerprint(data, len);
+        auto local = local_.find(fp);
+        if (local != local_.end()) {
+            local->second.refs++;
+            add_extent(file_id_, local->second.offset, len);
+            DEDUP_SAVED_BYTES += len;
+        } else if (auto stored = CHUNKS->find(fp)) {
+            referenced_.push_back(fp);
+            add_extent(stored->container, stored->offset, len);
+            DEDUP_SAVED_BYTES += len;
+        } else {
+            NewChunk chunk;
+            chunk.fp = fp;
+            chunk.offset = stripes_.size();
+            chunk.length = static_cast<uint32_t>(len);
+            local_.emplace(fp, chunk);
+            add_extent(file_id_, chunk.offset, len);
+            stripes_.write(reinterpret_cast<const char*>(data), len);
+        }
+    }
+
+    // Une el rango con el anterior si es su continuación en el mismo contenedor
+    void add_extent(const std::string& container, uint64_t offset, uint64_t length) {
+        if (!extents_.empty()) {
+            Extent& last = extents_.back();
+            if (last.container == container && last.offset + last.length == offset) {
+                last.length += length;
+                return;
+            }
+        }
+        extents_.push_back({container, offset, length});
+    }
+
+    std::string file_id_;
+    bool updatable_;
+    StripeUploader stripes_;
+    Chunker chunker_;
+    std::vector<Extent> extents_;
+    std::unordered_map<Fingerprint, NewChunk, FingerprintHash> local_; // chunks nuevos de esta subida
+    std::vector<Fingerprint> referenced_; // chunks repetidos de subidas anteriores
 };
 
-// mapa que guarda los tamaños de dato originales
-std::unordered_map<std::string, size_t> file_original_sizes;
+// Estado compartido de las lecturas de una franja; las lecturas tardías
+// escriben aquí aunque la franja ya se haya entregado
+struct StripeFetch {
+    std::mutex mutex;
+    std::condition_variable done;
+    Blocks shards;
+    std::vector<bool> present;
+    size_t available = 0;
+    size_t failed = 0;
+};
+
+// Bytes leídos de una franja a partir de begin (relativo al inicio de la franja)
+struct StripeRange {
+    size_t begin = 0;
+    ByteBlock data;
+};
+
+// Recupera los bytes [begin, end) de una franja (sin relleno ni compresión), ampliados a las
+// unidades de datos que los contienen. Pide esas unidades en paralelo (primero en nodos que no
+// estén ocupados con una lectura anterior ni bajo sospecha; los caídos, solo si no queda otra
+// y entonces se decodifica desde el principio); si alguna falla, o si tardan más que el percentil
+// configurado de latencia, completa con otras unidades y paridades hasta tener k y decodifica
+// solo lo que falta. Una unidad cuyo CRC32C no coincide con el guardado cuenta como fallida,
+// así que se repara con paridad en la misma lectura. Las franjas comprimidas se leen completas.
+StripeRange reconstruct_stripe(const std::shared_ptr<NodeLoad>& load, const ErasureCodec& codec,
+                               const FileMetadata& meta, const std::string& file_id, size_t stripe,
+                               size_t begin = 0, size_t end = SIZE_MAX) {
+    const StripeLayout& layout = meta.layout;
+    size_t k = layout.k;
+    size_t n = layout.k + layout.m;
+    size_t len = layout.unit_length(stripe);
+    const uint32_t* expected = stripe_checksums(meta, stripe);
+    StripeEncoding encoding = layout.encoding(stripe);
+
+    // Unidades de datos first..last que cubren el rango
+    size_t first = 0, last = k - 1;
+    if (encoding.compression == StripeCompression::None) {
+        end = std::min(end, layout.stripe_length(stripe));
+        first = begin / len;
+        last = std::max(first, (end - 1) / len);
+    }
+    auto wanted = [&](size_t i) { return i >= first && i <= last; };
+
+    auto state = std::make_shared<StripeFetch>();
+    state->shards.resize(n);
+    state->present.assign(n, false);
+
+    // Orden de preferencia: las unidades pedidas, luego los demás datos y por último la
+    // paridad; en cada grupo, nodos libres antes que ocupados o sospechosos. Los nodos caídos
+    // van al final de todo.
+    std::vector<NodeState> health(n, NodeState::Up);
+    if (NODE_HEALTH) {
+        for (size_t i = 0; i < n; i++) health[i] = NODE_HEALTH->state(layout.node(stripe, i));
+    }
+    std::vector<size_t> order;
+    for (int group = 0; group < 3; group++) {
+        for (int busy = 0; busy < 2; busy++) {
+            for (size_t i = 0; i < n; i++) {
+                if ((health[i] == NodeState::Down) != (group == 2)) continue;
+                bool node_busy = load->pending(layout.node(stripe, i)) > 0 || health[i] == NodeState::Suspect;
+                if ((group == 2 || wanted(i) == (group == 0)) && node_busy == (busy == 1)) order.push_back(i);
+            }
+        }
+    }
+
+    size_t issued = 0;
+    size_t next = 0;
+    auto issue = [&](size_t i) {
+        issued++;
+        size_t node = layout.node(stripe, i);
+        load->add(node, 1);
+        uint32_t checksum = expected ? expected[i] : 0;
+        IO_POOL->submit([state, load, block_id = unit_id(file_id, stripe, i, k), i, node, len, checksum,
+                         verify = expected != nullptr] {
+            auto start = std::chrono::steady_clock::now();
+            ByteBlock data;
+            bool ok = false;
+            // Nadie lee el future de esta tarea: una excepción cuenta como lectura fallida, si no
+            // la descarga esperaría para siempre una respuesta que nunca llega
+            try {
+                ok = with_node(node, [&](Client& client) {
+                    return fetch_block(client, block_id, data, TRANSPORT);
+                }) && data.size() == len;
+                if (ok) READ_LATENCY.record(elapsed_ms(start));
+                if (ok && verify && crc32c(data.data(), len) != checksum) {
+                    std::cerr << "Checksum mismatch in " << block_id << " from " << topology()->nodes[node].url << "\n";
+                    CORRUPT_UNITS++;
+                    ok = false;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Read of " << block_id << " failed: " << e.what() << "\n";
+                ok = false;
+            }
+            load->add(node, -1);
+
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (ok) {
+                state->shards[i] = std::move(data);
+                state->present[i] = true;
+                state->available++;
+            } else {
+                state->failed++;
+            }
+            state->done.notify_all();
+        });
+    };
+    auto have_wanted = [&](const std::vector<bool>& present) {
+        for (size_t i = first; i <= last; i++) {
+            if (!present[i]) return false;
+        }
+        return true;
+    };
+
+    // Pide las unidades del rango (las k de datos en una lectura completa)
+    size_t goal = last - first + 1; // unidades que hace falta recibir; k si hay que decodificar
+    for (size_t i = first; i <= last; i++) {
+        if (health[i] == NodeState::Down) goal = k;
+    }
+    for (; next < goal; next++) issue(order[next]);
+
+    double delay = READ_LATENCY.percentile(CONFIG.hedge_percentile, CONFIG.hedge_min_delay_ms);
+    auto hedge_at = std::chrono::steady_clock::now() +
+                    std::chrono::microseconds(static_cast<long long>(std::max(delay, CONFIG.hedge_min_delay_ms) * 1000));
+    bool hedged = false;
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (!have_wanted(state->present) && state->available < k) {
+        // Si una unidad pedida falló ya no alcanza con las demás: hay que decodificar
+        if (state->failed > 0) goal = k;
+        size_t in_flight = issued - state->available - state->failed;
+        // Cada lectura fallida se reemplaza de inmediato por otra unidad
+        size_t needed = goal - state->available;
+        while (in_flight < needed && next < n) {
+            issue(order[next++]);
+            in_flight++;
+        }
+        if (in_flight == 0) throw std::runtime_error("Not enough blocks to reconstruct " + file_id);
+
+        if (hedged || next == n) {
+            state->done.wait(lock);
+        } else if (state->done.wait_until(lock, hedge_at) == std::cv_status::timeout) {
+            // Las lecturas tardan más de lo normal: se completa hasta k unidades y se pide
+            // una extra por cada lectura pendiente
+            hedged = true;
+            goal = k;
+            size_t pending = in_flight;
+            while (in_flight < k - state->available + pending && next < n) {
+                issue(order[next++]);
+                in_flight++;
+            }
+            HEDGED_READS++;
+        }
+    }
+
+    // Copia las unidades recibidas; las lecturas tardías ya no se usan
+    Blocks shards(n);
+    std::vector<bool> present = state->present;
+    for (size_t i = 0; i < n; i++) {
+        if (present[i]) shards[i] = state->shards[i];
+    }
+    lock.unlock();
 
-ByteBlock calculate_parity(const Blocks& blocks) { // Calcula el bloque de paridad XOR
-    if (blocks.empty()) throw std::runtime_error("No blocks provided");
-    ByteBlock parity(blocks[0].size(), 0); //Crea byteblock de paridad
-    for (const auto& block : blocks) {
-        for (size_t i = 0; i < block.size(); ++i) {
-            parity[i] ^= block[i]; //Comparación XOR
+    bool decoded = !have_wanted(present);
+    if (decoded) {
+        std::vector<uint8_t*> ptrs;
+        for (size_t i = 0; i < n; i++) {
+            if (!present[i]) shards[i].assign(len, 0);
+            ptrs.push_back(shards[i].data());
         }
+        codec.reconstruct(ptrs.data(), present, len, true);
+        DEGRADED_STRIPES++;
     }
-    return parity;
+
+    // Concatena las unidades, elimina el relleno y descomprime si hace falta
+    StripeRange range;
+    range.begin = first * len;
+    range.data.reserve((last - first + 1) * len);
+    for (size_t i = first; i <= last; i++) range.data.insert(range.data.end(), shards[i].begin(), shards[i].end());
+    range.data.resize(std::min(range.data.size(), encoding.stored_length - range.begin));
+    if (encoding.compression != StripeCompression::None) {
+        ByteBlock plain(layout.stripe_length(stripe));
+        if (encoding.compression != StripeCompression::Lz4 ||
+            !lz4_decompress(range.data.data(), range.data.size(), plain.data(), plain.size())) {
+            throw std::runtime_error("Stripe " + std::to_string(stripe) + " of " + file_id + " failed to decompress");
+        }
+        range.data.swap(plain);
+    }
+
+    // Verifica también el resultado de decodificar o descomprimir; si no hubo ninguna de las
+    // dos cosas los datos son las unidades ya verificadas y no hace falta otra pasada
+    bool transformed = decoded || encoding.compression != StripeCompression::None;
+    bool whole = first == 0 && last == k - 1;
+    if (transformed && whole && stripe < meta.stripe_checksums.size() &&
+        crc32c(range.data.data(), range.data.size()) != meta.stripe_checksums[stripe]) {
+        throw std::runtime_error("Checksum mismatch in stripe " + std::to_string(stripe) + " of " + file_id);
+    }
+    if (decoded && !whole && expected) {
+        for (size_t i = first; i <= last; i++) {
+            if (!present[i] && crc32c(shards[i].data(), len) != expected[i]) {
+                throw std::runtime_error("Checksum mismatch in decoded unit " + std::to_string(i) + " of stripe " +
+                                         std::to_string(stripe) + " of " + file_id);
+            }
+        }
+    }
+    return range;
 }
 
-void distribute_blocks(const Blocks& blocks, const std::string& file_id) {
-    std::vector<Client> clients;
-    for (const auto& url : DISK_NODES) {
-        clients.push_back(Client(url.c_str()));
+// Entrega un archivo franja por franja; solo la franja actual se guarda en memoria. Antes de
+// pedirla a los nodos se busca en STRIPE_CACHE; una franja que ya se pidió antes se lee completa
+// (aunque el pedido sea un rango) para que pueda entrar en la caché. Cada franja se lee con el
+// candado del archivo compartido (lock_stripe) y los metadatos al día, así una escritura en sitio
+// o un rebalanceo simultáneos no dejan ver unidades nuevas con los CRC32C viejos.
+class StripeReader {
+public:
+    StripeReader(std::string file_id, const FileMetadata& meta)
+        : file_id_(std::move(file_id)), meta_(meta), codec_(codec_for(meta)),
+          load_(std::make_shared<NodeLoad>(topology()->size())) {}
+
+    // Bytes desde offset hasta el final de la parte leída de su franja, que cubre al menos
+    // length bytes o hasta el final de la franja; solo se piden las unidades necesarias
+    std::pair<const uint8_t*, size_t> view(size_t offset, size_t length) {
+        size_t stripe = offset / meta_->layout.stripe_width();
+        size_t begin = offset - meta_->layout.stripe_offset(stripe);
+        bool cached = stripe == current_stripe_ && begin >= current_begin_ &&
+                      begin < current_begin_ + current_->size();
+        if (!cached) load(stripe, begin, begin + length);
+        size_t skip = begin - current_begin_;
+        return {current_->data() + skip, current_->size() - skip};
     }
 
-    // envía 3 bloques a los primeros 3 nodos
-    for (int i = 0; i < 3; i++) {
-        json block_json;
-        block_json["id"] = file_id + "_block" + std::to_string(i);
-        block_json["data"] = blocks[i];
+private:
+    void load(size_t stripe, size_t begin, size_t end) {
+        SharedFileLock file = lock_stripe<SharedFileLock>(file_id_, meta_, meta_version_);
+        // El CRC32C de la franja cambia con cada escritura en sitio
+        uint32_t version = stripe < meta_->stripe_checksums.size() ? meta_->stripe_checksums[stripe] : 0;
+        if (STRIPE_CACHE) {
+            if (StripeCache::Data hit = STRIPE_CACHE->get(file_id_, stripe, version)) {
+                current_ = std::move(hit);
+                current_begin_ = 0;
+                current_stripe_ = stripe;
+                return;
+            }
+            if (STRIPE_CACHE->frequency(file_id_, stripe) >= 2) {
+                begin = 0;
+                end = SIZE_MAX;
+            }
+        }
+        StripeRange range = reconstruct_stripe(load_, *codec_, *meta_, file_id_, stripe, begin, end);
+        current_begin_ = range.begin;
+        current_ = std::make_shared<const ByteBlock>(std::move(range.data));
+        current_stripe_ = stripe;
+        if (STRIPE_CACHE && current_begin_ == 0 && current_->size() == meta_->layout.stripe_length(stripe)) {
+            STRIPE_CACHE->put(file_id_, stripe, version, current_);
+        }
+    }
 
-        auto res = clients[i].Post("/store", block_json.dump(), "application/json");
-        if (!res) {
-            std::cerr << "Connection failed to node " << (i+1) << "\n";
-        } else if (res->status != 200) {
-            std::cerr << "Error storing block " << i << " on node " << (i+1)
-                      << ": " << res->status << " - " << res->body << "\n";
+    std::string file_id_;
+    std::optional<FileMetadata> meta_;
+    uint64_t meta_version_ = UINT64_MAX; // de lock_stripe
+    std::shared_ptr<const ErasureCodec> codec_;
+    std::shared_ptr<NodeLoad> load_;
+    StripeCache::Data current_;
+    size_t current_begin_ = 0;
+    size_t current_stripe_ = SIZE_MAX;
+};
+
+// Entrega un archivo siguiendo sus extents; cada contenedor se lee con su propio
+// StripeReader (se conservan los últimos MAX_CONTAINERS para no reconstruir franjas de más)
+class FileReader {
+public:
+    FileReader(std::string file_id, const FileMetadata& meta) : file_id_(std::move(file_id)), meta_(meta) {
+        extents_ = meta.extents;
+        if (extents_.empty()) extents_.push_back({file_id_, 0, meta.layout.file_size});
+        uint64_t start = 0;
+        for (const auto& extent : extents_) {
+            starts_.push_back(start);
+            start += extent.length;
+        }
+    }
+
+    // Escribe en sink los bytes desde offset hasta el final de su extent o franja (máximo length)
+    bool read(size_t offset, size_t length, DataSink& sink) {
+        size_t e = std::upper_bound(starts_.begin(), starts_.end(), offset) - starts_.begin() - 1;
+        const Extent& extent = extents_[e];
+        size_t delta = offset - starts_[e];
+        // Se lee de la franja todo lo que falta del pedido (no solo este extent): en una descarga
+        // completa eso son las k unidades en paralelo, aunque el archivo tenga extents pequeños
+        auto [data, available] = container(extent.container).view(extent.offset + delta, length);
+        size_t n = std::min({length, available, static_cast<size_t>(extent.length - delta)});
+        return sink.write(reinterpret_cast<const char*>(data), n);
+    }
+
+private:
+    static constexpr size_t MAX_CONTAINERS = 4;
+
+    StripeReader& container(const std::string& id) {
+        auto it = std::find_if(readers_.begin(), readers_.end(), [&](const auto& r) { return r.first == id; });
+        if (it != readers_.end()) {
+            std::rotate(readers_.begin(), it, it + 1);
+            return *readers_.front().second;
         }
+        std::optional<FileMetadata> meta = id == file_id_ ? meta_ : METADATA->get(id);
+        if (!meta) throw std::runtime_error("Missing container " + id);
+        if (readers_.size() == MAX_CONTAINERS) readers_.pop_back();
+        readers_.emplace(readers_.begin(), id, std::make_unique<StripeReader>(id, *meta));
+        return *readers_.front().second;
     }
 
-    // Calcula y envía paridad al nodo 4
-    ByteBlock parity = calculate_parity({blocks[0], blocks[1], blocks[2]});
-    json parity_json;
-    parity_json["id"] = file_id + "_parity";
-    parity_json["data"] = parity;
+    std::string file_id_;
+    FileMetadata meta_;
+    std::vector<Extent> extents_;
+    std::vector<uint64_t> starts_; // posición de cada extent en el archivo
+    std::vector<std::pair<std::string, std::unique_ptr<StripeReader>>> readers_; // el más reciente primero
+};
+
+// Calcula el contenido nuevo de las unidades de la franja que cambian al escribir data en
+// [begin, end) (relativo al inicio de la franja). Lee solo las unidades de datos tocadas y las
+// m paridades, y actualiza cada paridad con el delta viejo ^ nuevo de los datos (la paridad es
+// lineal, así que las demás unidades no hacen falta); el CRC32C de la franja se actualiza igual,
+// con el CRC del delta. Si alguna de esas unidades falta o no pasa su CRC32C, reconstruye la
+// franja completa desde las que haya y la vuelve a codificar.
+StripePatch prepare_patch(const FileMetadata& meta, const ErasureCodec& codec, const std::string& file_id,
+                          size_t stripe, size_t begin, size_t end, const uint8_t* data) {
+    const StripeLayout& layout = meta.layout;
+    size_t k = layout.k;
+    size_t m = layout.m;
+    size_t len = layout.unit_length(stripe);
+    size_t stored_len = layout.stored_length(stripe);
+    const uint32_t* expected = stripe_checksums(meta, stripe);
+    size_t first = begin / len;
+    size_t last = (end - 1) / len;
+
+    StripePatch patch;
+    patch.file_id = file_id;
+    patch.stripe = stripe;
+    for (size_t i = first; i <= last; i++) patch.units.push_back(i);
+    for (size_t j = 0; j < m; j++) patch.units.push_back(k + j);
+    patch.contents.resize(patch.units.size());
+    std::vector<std::future<bool>> reads;
+    for (size_t u = 0; u < patch.units.size(); u++) {
+        reads.push_back(IO_POOL->submit([&, u] {
+            size_t i = patch.units[u];
+            ByteBlock& unit = patch.contents[u];
+            bool ok = with_node(layout.node(stripe, i), [&](Client& client) {
+                return fetch_block(client, unit_id(file_id, stripe, i, k), unit, TRANSPORT);
+            });
+            return ok && unit.size() == len && crc32c(unit.data(), len) == expected[i];
+        }));
+    }
+    bool all_read = true;
+    for (auto& read : reads) all_read &= read.get();
+    PATCH_NODE_BYTES += patch.units.size() * len;
+
+    if (all_read) {
+        // El delta solo es distinto de cero en [a, b) de cada unidad, y la paridad igual
+        ByteBlock delta(len);
+        std::vector<uint8_t*> parity(m);
+        uint32_t delta_crc = crc32c_zeros(begin);
+        for (size_t i = first; i <= last; i++) {
+            ByteBlock& unit = patch.contents[i - first];
+            size_t a = std::max(begin, i * len) - i * len;
+            size_t b = std::min(end, (i + 1) * len) - i * len;
+            std::memcpy(delta.data() + a, unit.data() + a, b - a);
+            std::memcpy(unit.data() + a, data + (i * len + a - begin), b - a);
+            xor_into(delta.data() + a, unit.data() + a, b - a);
+            for (size_t j = 0; j < m; j++) parity[j] = patch.contents[last - first + 1 + j].data() + a;
+            codec.update_parity(i, delta.data() + a, parity.data(), b - a);
+            delta_crc = crc32c_combine(delta_crc, crc32c(delta.data() + a, b - a), b - a);
+        }
+        // crc(viejo ^ delta) = crc(viejo) ^ crc(delta) ^ crc(ceros), todos del largo de la franja
+        delta_crc = crc32c_combine(delta_crc, crc32c_zeros(stored_len - end), stored_len - end);
+        patch.stripe_checksum = meta.stripe_checksums[stripe] ^ delta_crc ^ crc32c_zeros(stored_len);
+    } else {
+        PATCH_FALLBACKS++;
+        auto load = std::make_shared<NodeLoad>(topology()->size());
+        StripeRange whole = reconstruct_stripe(load, codec, meta, file_id, stripe);
+        PATCH_NODE_BYTES += k * len;
+        std::memcpy(whole.data.data() + begin, data, end - begin);
+        patch.stripe_checksum = crc32c(whole.data.data(), stored_len);
+        whole.data.resize(k * len, 0);
+
+        patch.units.clear();
+        patch.contents.assign(k + m, ByteBlock(len));
+        std::vector<const uint8_t*> data_ptrs;
+        std::vector<uint8_t*> parity_ptrs;
+        for (size_t i = 0; i < k; i++) {
+            std::memcpy(patch.contents[i].data(), whole.data.data() + i * len, len);
+            data_ptrs.push_back(patch.contents[i].data());
+        }
+        for (size_t j = 0; j < m; j++) parity_ptrs.push_back(patch.contents[k + j].data());
+        codec.encode(data_ptrs.data(), parity_ptrs.data(), len);
+        for (size_t i = 0; i < k + m; i++) patch.units.push_back(i);
+    }
+    for (const auto& unit : patch.contents) patch.checksums.push_back(crc32c(unit.data(), unit.size()));
+    return patch;
+}
 
-    auto res = clients[3].Post("/store", parity_json.dump(), "application/json");
-    if (!res) {
-        std::cerr << "Connection failed to node 4 (parity)\n";
-    } else if (res->status != 200) {
-        std::cerr << "Error storing parity on node 4: "
-                  << res->status << " - " << res->body << "\n";
+// Escribe en los nodos las unidades de una franja ya registrada en el journal y publica sus
+// CRC32C nuevos. Una unidad que no se pudo escribir conserva el contenido anterior, que ya no
+// coincide con su CRC, así que se lee como faltante y se repara con paridad. Devuelve false
+// (y la franja sigue pendiente en el journal) si quedan menos de k unidades correctas. Se llama
+// con el candado del archivo tomado (o al arrancar, antes de que haya otros hilos).
+bool commit_patch(uint64_t seq, const StripePatch& patch) {
+    std::optional<FileMetadata> meta = METADATA->get(patch.file_id);
+    if (!meta) {
+        PATCH_JOURNAL->end(seq);
+        return true;
+    }
+    size_t k = meta->layout.k;
+    size_t n = meta->layout.k + meta->layout.m;
+    std::vector<std::future<bool>> writes;
+    for (size_t u = 0; u < patch.units.size(); u++) {
+        writes.push_back(IO_POOL->submit([&, u] {
+            size_t i = patch.units[u];
+            const ByteBlock& unit = patch.contents[u];
+            return store_unit(meta->layout.node(patch.stripe, i), unit_id(patch.file_id, patch.stripe, i, k),
+                              unit.data(), unit.size());
+        }));
     }
+    size_t failed = 0;
+    for (auto& write : writes) failed += write.get() ? 0 : 1;
+    for (const auto& unit : patch.contents) PATCH_NODE_BYTES += unit.size();
+    if (n - failed < k) return false;
+    if (failed > 0) {
+        std::cerr << "Stripe " << patch.stripe << " of " << patch.file_id << " updated degraded ("
+                  << n - failed << "/" << n << " units)\n";
+    }
+
+    size_t base = patch.stripe * n;
+    for (size_t u = 0; u < patch.units.size(); u++) meta->checksums[base + patch.units[u]] = patch.checksums[u];
+    meta->stripe_checksums[patch.stripe] = patch.stripe_checksum;
+    put_locked(patch.file_id, *meta);
+    if (STRIPE_CACHE) STRIPE_CACHE->invalidate(patch.file_id, patch.stripe);
+    PATCH_JOURNAL->end(seq);
+    return true;
 }
 
-Blocks reconstruct_file(const std::string& file_id) {
-    std::vector<Client> clients;
-    for (const auto& url : DISK_NODES) {
-        clients.push_back(Client(url.c_str()));
+// Reconstrucción en segundo plano (resilver) de las unidades de un nodo que se vació o que se
+// reemplazó por uno nuevo en la misma dirección. Recorre los archivos en orden de id con
+// rebuild_parallelism hilos: en cada franja lee la unidad del nodo y, si falta o su CRC32C no
+// coincide, la decodifica desde las demás y la vuelve a escribir. Todo el tráfico pasa por un
+// RateLimiter de rebuild_bandwidth_mb para no competir con las descargas. El avance (último id
+// con todos los anteriores terminados) se guarda en rebuild.json y se retoma al arrancar.
+class NodeRebuild {
+public:
+    struct Progress {
+        size_t node = 0;
+        bool running = false;
+        std::string error;            // motivo por el que se detuvo antes de terminar
+        size_t files_total = 0;
+        size_t files_done = 0;
+        uint64_t units_checked = 0;
+        uint64_t units_rebuilt = 0;
+        uint64_t units_lost = 0;      // faltan más de m unidades en la franja
+        uint64_t bytes = 0;           // leídos y escritos
+        std::string resumed_after;
+    };
+
+    NodeRebuild(size_t node, std::string checkpoint_path, std::string resume_after = "")
+        : node_(node), checkpoint_path_(std::move(checkpoint_path)),
+          limiter_(CONFIG.rebuild_bandwidth_mb * 1000 * 1000) {
+        progress_.node = node;
+        progress_.running = true;
+        progress_.resumed_after = std::move(resume_after);
+        thread_ = std::thread(&NodeRebuild::run, this);
     }
 
-    Blocks recovered_blocks;
+    ~NodeRebuild() {
+        stop_ = true;
+        thread_.join();
+    }
 
-    // Intenta recuperar los 3 bloques
-    for (int i = 0; i < 3; i++) {
-        std::string block_id = file_id + "_block" + std::to_string(i);
-        auto res = clients[i].Get(("/retrieve/" + block_id).c_str());
+    NodeRebuild(const NodeRebuild&) = delete;
+    NodeRebuild& operator=(const NodeRebuild&) = delete;
 
-        if (res && res->status == 200) {
-            try {
-                auto json_data = json::parse(res->body);
-                recovered_blocks.push_back(json_data["data"].get<ByteBlock>());
-            } catch (const json::exception& e) {
-                std::cerr << "JSON error for block " << i << ": " << e.what() << "\n";
+    Progress progress() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return progress_;
+    }
+
+private:
+    enum class Outcome { Healthy, Decoded, Rebuilt, Lost, TargetDown };
+
+    void run() {
+        std::vector<std::string> ids = METADATA->file_ids();
+        const std::string& after = progress_.resumed_after;
+        if (!after.empty()) ids.erase(ids.begin(), std::upper_bound(ids.begin(), ids.end(), after));
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            progress_.files_total = ids.size();
+        }
+        save_checkpoint(after);
+
+        // Los archivos terminan en desorden; el checkpoint avanza hasta el primero pendiente
+        std::vector<bool> done(ids.size(), false);
+        size_t watermark = 0;
+        auto last_save = std::chrono::steady_clock::now();
+        std::atomic<size_t> next{0};
+        auto worker = [&] {
+            while (!stop_) {
+                size_t i = next++;
+                if (i >= ids.size()) return;
+                try {
+                    if (!rebuild_file(ids[i])) return;
+                } catch (const std::exception& e) {
+                    // Un archivo que no se puede decodificar detiene la reconstrucción como un
+                    // nodo caído: el checkpoint queda antes de él
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    progress_.error = ids[i] + ": " + e.what();
+                    stop_ = true;
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(mutex_);
+                done[i] = true;
+                progress_.files_done++;
+                while (watermark < ids.size() && done[watermark]) watermark++;
+                if (watermark > 0 && elapsed_ms(last_save) > 1000) {
+                    save_checkpoint(ids[watermark - 1]);
+                    last_save = std::chrono::steady_clock::now();
+                }
             }
+        };
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < CONFIG.rebuild_parallelism; t++) workers.emplace_back(worker);
+        for (auto& t : workers) t.join();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        progress_.running = false;
+        if (watermark == ids.size()) {
+            std::error_code ec;
+            fs::remove(checkpoint_path_, ec);
+            std::cout << "Rebuild of " << topology()->nodes[node_].url << " finished: " << progress_.units_rebuilt
+                      << " units rebuilt, " << progress_.units_lost << " lost\n";
         } else {
-            std::cerr << "Failed to get block " << i << ": "
-                      << (res ? res->status : -1) << "\n";
+            if (watermark > 0) save_checkpoint(ids[watermark - 1]);
+            if (progress_.error.empty()) progress_.error = "stopped";
         }
     }
 
-    // Si falta un bloque, usa la paridad para reconstruirlo
-    if (recovered_blocks.size() < 3) {
-        auto parity_res = clients[3].Get(("/retrieve/" + file_id + "_parity").c_str());
-        if (!parity_res || parity_res->status != 200) {
-            throw std::runtime_error("Parity block retrieval failed");
+    // Devuelve false si el nodo destino dejó de responder (el archivo queda pendiente). Cada
+    // franja se lee y se decodifica sin el candado del archivo, para no frenar las escrituras en
+    // sitio con el RateLimiter; el candado se toma solo para confirmar que los metadatos no
+    // cambiaron mientras tanto (si cambiaron se repite la franja) y escribir la unidad.
+    bool rebuild_file(const std::string& file_id) {
+        std::optional<FileMetadata> meta = METADATA->get(file_id);
+        if (!meta) return true;
+        std::shared_ptr<const ErasureCodec> codec = codec_for(*meta);
+        uint64_t version = UINT64_MAX;
+        lock_stripe(file_id, meta, version); // solo para conocer la versión de los metadatos
+        size_t n = meta->layout.k + meta->layout.m;
+        for (size_t stripe = 0; stripe < meta->layout.stripe_count(); stripe++) {
+            Outcome outcome = Outcome::Healthy;
+            ByteBlock unit;
+            FileLock file;
+            bool confirmed = false;
+            while (!confirmed) {
+                if (stop_) return false;
+                // El nodo no guarda ninguna unidad de esta franja
+                if (meta->layout.unit_on(stripe, node_) == n) break;
+                outcome = read_stripe(*meta, *codec, file_id, stripe, unit);
+                confirmed = confirm_stripe(file_id, meta, version, file);
+            }
+            if (!confirmed) continue;
+            if (outcome == Outcome::Decoded) {
+                size_t target = meta->layout.unit_on(stripe, node_);
+                bool stored = store_unit(node_, unit_id(file_id, stripe, target, meta->layout.k), unit.data(), unit.size());
+                outcome = stored ? Outcome::Rebuilt : Outcome::TargetDown;
+            }
+            if (file.owns_lock()) file.unlock();
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            progress_.units_checked++;
+            if (outcome == Outcome::Rebuilt) progress_.units_rebuilt++;
+            if (outcome == Outcome::Lost) progress_.units_lost++;
+            if (outcome == Outcome::TargetDown) {
+                progress_.error = topology()->nodes[node_].url + " did not accept rebuilt units";
+                stop_ = true;
+                return false;
+            }
         }
+        return true;
+    }
+
+    // Lee la unidad que le toca al nodo en la franja y, si falta o no pasa su CRC32C, la
+    // decodifica en unit desde las demás (Decoded; el ancho de banda para escribirla ya se reservó)
+    Outcome read_stripe(const FileMetadata& meta, const ErasureCodec& codec, const std::string& file_id,
+                        size_t stripe, ByteBlock& unit) {
+        const StripeLayout& layout = meta.layout;
+        size_t k = layout.k;
+        size_t n = layout.k + layout.m;
+        size_t len = layout.unit_length(stripe);
+        const uint32_t* expected = stripe_checksums(meta, stripe);
+        size_t target = layout.unit_on(stripe, node_); // unidad que le toca al nodo en esta franja
+
+        auto fetch = [&](size_t i, ByteBlock& data) {
+            limiter_.acquire(len);
+            count_bytes(len);
+            bool ok = with_node(layout.node(stripe, i), [&](Client& client) {
+                return fetch_block(client, unit_id(file_id, stripe, i, k), data, TRANSPORT);
+            });
+            return ok && data.size() == len && (!expected || crc32c(data.data(), len) == expected[i]);
+        };
 
-        auto parity_json = json::parse(parity_res->body);
-        ByteBlock parity = parity_json["data"].get<ByteBlock>();
-        ByteBlock recovered_block(parity.size(), 0);
+        Blocks shards(n);
+        if (fetch(target, shards[target])) return Outcome::Healthy;
 
-        for (size_t j = 0; j < parity.size(); j++) {
-            uint8_t value = parity[j];
-            for (const auto& block : recovered_blocks) {
-                value ^= block[j];
+        // Las primeras k unidades válidas del resto de los nodos (datos antes que paridad)
+        std::vector<bool> present(n, false);
+        size_t available = 0;
+        for (size_t i = 0; i < n && available < k; i++) {
+            if (i != target && fetch(i, shards[i])) {
+                present[i] = true;
+                available++;
             }
-            recovered_block[j] = value;
         }
-        recovered_blocks.push_back(recovered_block);
+        if (available < k) {
+            std::cerr << "Rebuild: stripe " << stripe << " of " << file_id << " has only "
+                      << available << " readable units\n";
+            return Outcome::Lost;
+        }
+        std::vector<uint8_t*> ptrs;
+        for (size_t i = 0; i < n; i++) {
+            if (!present[i]) shards[i].assign(len, 0);
+            ptrs.push_back(shards[i].data());
+        }
+        codec.reconstruct(ptrs.data(), present, len, false);
+        if (expected && crc32c(shards[target].data(), len) != expected[target]) {
+            std::cerr << "Rebuild: decoded unit of stripe " << stripe << " of " << file_id << " fails its checksum\n";
+            return Outcome::Lost;
+        }
+
+        limiter_.acquire(len);
+        count_bytes(len);
+        unit = std::move(shards[target]);
+        return Outcome::Decoded;
+    }
+
+    void count_bytes(size_t len) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        progress_.bytes += len;
+    }
+
+    void save_checkpoint(const std::string& after) {
+        try {
+            replace_file(checkpoint_path_, json{{"node", node_}, {"after", after}}.dump());
+        } catch (const std::exception& e) {
+            std::cerr << "Rebuild checkpoint not saved: " << e.what() << "\n";
+        }
+    }
+
+    size_t node_;
+    std::string checkpoint_path_;
+    RateLimiter limiter_;
+    std::atomic<bool> stop_{false};
+    mutable std::mutex mutex_;
+    Progress progress_;
+    std::thread thread_;
+};
+
+// Rebalanceo en segundo plano después de registrar un nodo o cambiar un peso: recorre los
+// archivos repartidos con el anillo y muda cada franja a los nodos que el anillo actual le
+// asigna. Solo se copian las unidades de los nodos que quedaron fuera (alrededor de 1/N); las
+// demás no se tocan aunque cambie su orden. Se copia la unidad, después se cambian los
+// metadatos y recién entonces se borra la copia vieja: las descargas leen cada franja con el
+// candado del archivo, así que ninguna sigue usando la ubicación anterior. Usa
+// rebalance_parallelism hilos y un RateLimiter de rebalance_bandwidth_mb; el avance se guarda
+// en rebalance.json como el de la reconstrucción y se retoma al arrancar.
+class Rebalancer {
+public:
+    struct Progress {
+        uint64_t topology_version = 0;
+        bool running = false;
+        std::string error;            // motivo por el que se detuvo antes de terminar
+        size_t files_total = 0;
+        size_t files_done = 0;
+        uint64_t stripes_checked = 0;
+        uint64_t stripes_moved = 0;
+        uint64_t stripes_failed = 0;  // no se pudieron leer o escribir: quedan donde estaban
+        uint64_t units_moved = 0;
+        uint64_t bytes = 0;           // leídos y escritos
+        double elapsed_s = 0;
+        std::string resumed_after;
+    };
+
+    static constexpr size_t BATCH_STRIPES = 16; // franjas por escritura de metadatos
+    static constexpr size_t MAX_ATTEMPTS = 3;   // copias de una franja que cambia mientras se copia
+
+    Rebalancer(std::string checkpoint_path, std::string resume_after = "")
+        : topology_(topology()), checkpoint_path_(std::move(checkpoint_path)),
+          limiter_(CONFIG.rebalance_bandwidth_mb * 1000 * 1000), start_(std::chrono::steady_clock::now()) {
+        progress_.topology_version = topology_->version;
+        progress_.running = true;
+        progress_.resumed_after = std::move(resume_after);
+        thread_ = std::thread(&Rebalancer::run, this);
+    }
+
+    ~Rebalancer() {
+        stop_ = true;
+        thread_.join();
+    }
+
+    Rebalancer(const Rebalancer&) = delete;
+    Rebalancer& operator=(const Rebalancer&) = delete;
+
+    Progress progress() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Progress p = progress_;
+        if (p.running) p.elapsed_s = elapsed_ms(start_) / 1000;
+        return p;
+    }
+
+private:
+    enum class Outcome { Placed, Moved, Failed };
+
+    void run() {
+        std::vector<std::string> ids = METADATA->file_ids();
+        const std::string& after = progress_.resumed_after;
+        if (!after.empty()) ids.erase(ids.begin(), std::upper_bound(ids.begin(), ids.end(), after));
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            progress_.files_total = ids.size();
+        }
+        save_checkpoint(after);
+
+        std::vector<bool> done(ids.size(), false);
+        size_t watermark = 0;
+        auto last_save = std::chrono::steady_clock::now();
+        std::atomic<size_t> next{0};
+        auto worker = [&] {
+            while (!stop_) {
+                size_t i = next++;
+                if (i >= ids.size()) return;
+                try {
+                    rebalance_file(ids[i]);
+                } catch (const std::exception& e) {
+                    // Sin poder guardar metadatos no tiene sentido seguir copiando
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    progress_.error = e.what();
+                    stop_ = true;
+                }
+                if (stop_) return;
+                std::lock_guard<std::mutex> lock(mutex_);
+                done[i] = true;
+                progress_.files_done++;
+                while (watermark < ids.size() && done[watermark]) watermark++;
+                if (watermark > 0 && elapsed_ms(last_save) > 1000) {
+                    save_checkpoint(ids[watermark - 1]);
+                    last_save = std::chrono::steady_clock::now();
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < CONFIG.rebalance_parallelism; t++) workers.emplace_back(worker);
+        for (auto& t : workers) t.join();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        progress_.running = false;
+        progress_.elapsed_s = elapsed_ms(start_) / 1000;
+        if (watermark == ids.size()) {
+            std::error_code ec;
+            fs::remove(checkpoint_path_, ec);
+            if (progress_.stripes_failed > 0) {
+                progress_.error = std::to_string(progress_.stripes_failed) + " stripes could not be moved";
+            }
+            std::cout << "Rebalance to topology " << progress_.topology_version << " finished: "
+                      << progress_.stripes_moved << " stripes moved, " << progress_.units_moved << " units, "
+                      << progress_.stripes_failed << " failed\n";
+        } else {
+            if (watermark > 0) save_checkpoint(ids[watermark - 1]);
+            if (progress_.error.empty()) progress_.error = "stopped";
+        }
+    }
+
+    // Franja cuyas unidades ya se copiaron a sus nodos nuevos, a la espera de publicarla
+    struct Move {
+        size_t stripe = 0;
+        std::vector<uint16_t> to;  // nodos nuevos de la franja
+        std::vector<size_t> units; // unidades que cambian de nodo
+    };
+
+    // Muda las franjas de a BATCH_STRIPES; una franja que recibió una escritura en sitio
+    // mientras se copiaba se vuelve a copiar, hasta MAX_ATTEMPTS veces
+    void rebalance_file(const std::string& file_id) {
+        std::optional<FileMetadata> meta = METADATA->get(file_id);
+        if (!meta || meta->layout.placement != Placement::Hashed) return;
+        std::shared_ptr<const ErasureCodec> codec = codec_for(*meta);
+        size_t count = meta->layout.stripe_count();
+        for (size_t first = 0; first < count && !stop_; first += BATCH_STRIPES) {
+            std::vector<size_t> stripes;
+            for (size_t stripe = first; stripe < std::min(count, first + BATCH_STRIPES); stripe++) stripes.push_back(stripe);
+            for (size_t attempt = 1; !stripes.empty() && !stop_; attempt++) {
+                stripes = move_batch(file_id, *codec, stripes, attempt == MAX_ATTEMPTS);
+            }
+        }
+    }
+
+    // Copia las unidades de las franjas sin el candado del archivo, así las escrituras en sitio,
+    // la reconstrucción y el scrub no esperan al RateLimiter. El candado se toma solo para
+    // publicar los nodos nuevos de las franjas cuyos metadatos no cambiaron mientras tanto; al
+    // final se borran las copias que ya nadie lee (las viejas de las franjas publicadas y las
+    // nuevas de las que cambiaron). Devuelve las franjas que cambiaron, para repetirlas (salvo en
+    // el último intento, en el que quedan donde estaban y cuentan como fallidas).
+    std::vector<size_t> move_batch(const std::string& file_id, const ErasureCodec& codec,
+                                   const std::vector<size_t>& stripes, bool last_attempt) {
+        std::optional<FileMetadata> meta = METADATA->get(file_id);
+        if (!meta) return {};
+        size_t n = meta->layout.k + meta->layout.m;
+        std::vector<Move> moves;
+        std::vector<size_t> failed;
+        for (size_t stripe : stripes) {
+            if (stop_) return {};
+            if (move_stripe(*meta, codec, file_id, stripe, moves) == Outcome::Failed) failed.push_back(stripe);
+        }
+
+        std::vector<bool> published(moves.size(), false);
+        std::vector<size_t> retry;
+        {
+            std::lock_guard<std::shared_mutex> file(file_lock(file_id));
+            std::optional<FileMetadata> current = METADATA->get(file_id);
+            if (!current) return {};
+            auto unchanged = [&](size_t stripe) {
+                const uint32_t* copied = stripe_checksums(*meta, stripe);
+                const uint32_t* now = stripe_checksums(*current, stripe);
+                const uint16_t* nodes = meta->layout.stripe_nodes.data() + stripe * n;
+                return (copied && now ? std::equal(copied, copied + n, now) : copied == now) &&
+                       std::equal(nodes, nodes + n, current->layout.stripe_nodes.data() + stripe * n);
+            };
+            bool changed = false;
+            for (size_t i = 0; i < moves.size(); i++) {
+                if (unchanged(moves[i].stripe)) {
+                    std::copy(moves[i].to.begin(), moves[i].to.end(), current->layout.stripe_nodes.data() + moves[i].stripe * n);
+                    published[i] = true;
+                    changed = true;
+                } else if (!last_attempt) {
+                    retry.push_back(moves[i].stripe);
+                }
+            }
+            // Una franja que no se pudo leer quizás estaba recibiendo una escritura en sitio
+            if (!last_attempt) {
+                std::erase_if(failed, [&](size_t stripe) {
+                    if (unchanged(stripe)) return false;
+                    retry.push_back(stripe);
+                    return true;
+                });
+            }
+            if (changed) put_locked(file_id, *current);
+        }
+
+        for (size_t i = 0; i < moves.size(); i++) {
+            const Move& move = moves[i];
+            const uint16_t* old_nodes = meta->layout.stripe_nodes.data() + move.stripe * n;
+            for (size_t unit : move.units) {
+                size_t unused = published[i] ? old_nodes[unit] : move.to[unit];
+                delete_unit(unused, unit_id(file_id, move.stripe, unit, meta->layout.k));
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        progress_.stripes_checked += stripes.size() - retry.size();
+        progress_.stripes_failed += failed.size();
+        for (size_t i = 0; i < moves.size(); i++) {
+            if (published[i]) {
+                progress_.stripes_moved++;
+                progress_.units_moved += moves[i].units.size();
+            } else if (last_attempt) {
+                std::cerr << "Rebalance: stripe " << moves[i].stripe << " of " << file_id
+                          << " kept changing while it was copied, left in place\n";
+                progress_.stripes_failed++;
+            }
+        }
+        return retry;
+    }
+
+    // Copia a sus nodos nuevos las unidades de la franja que están en nodos que el anillo ya no
+    // le asigna y agrega la mudanza a moves; una unidad que no se puede leer se decodifica desde
+    // las demás
+    Outcome move_stripe(const FileMetadata& meta, const ErasureCodec& codec, const std::string& file_id,
+                        size_t stripe, std::vector<Move>& moves) {
+        const StripeLayout& layout = meta.layout;
+        size_t k = layout.k;
+        size_t n = layout.k + layout.m;
+        if (layout.stripe_nodes.size() < (stripe + 1) * n) return Outcome::Placed;
+        const uint16_t* current = layout.stripe_nodes.data() + stripe * n;
+        std::vector<uint16_t> target(n);
+        topology_->ring->place(file_id, stripe, target.data());
+
+        // Los nodos elegidos que todavía no tienen unidad reciben las de los que quedaron fuera
+        std::vector<uint16_t> incoming;
+        for (uint16_t node : target) {
+            if (std::find(current, current + n, node) == current + n) incoming.push_back(node);
+        }
+        if (incoming.empty()) return Outcome::Placed;
+        std::vector<size_t> moved;
+        std::vector<uint16_t> next(current, current + n);
+        for (size_t i = 0; i < n; i++) {
+            if (std::find(target.begin(), target.end(), current[i]) != target.end()) continue;
+            next[i] = incoming[moved.size()];
+            moved.push_back(i);
+        }
+
+        size_t len = layout.unit_length(stripe);
+        const uint32_t* expected = stripe_checksums(meta, stripe);
+        Blocks shards(n);
+        std::vector<bool> present(n, false);
+        auto fetch = [&](size_t i) {
+            limiter_.acquire(len);
+            count_bytes(len);
+            bool ok = with_node(current[i], [&](Client& client) {
+                return fetch_block(client, unit_id(file_id, stripe, i, k), shards[i], TRANSPORT);
+            });
+            present[i] = ok && shards[i].size() == len && (!expected || crc32c(shards[i].data(), len) == expected[i]);
+            return present[i];
+        };
+        bool all_read = true;
+        for (size_t i : moved) all_read &= fetch(i);
+        if (!all_read) {
+            size_t available = std::count(present.begin(), present.end(), true);
+            for (size_t i = 0; i < n && available < k; i++) {
+                if (!present[i] && std::find(moved.begin(), moved.end(), i) == moved.end() && fetch(i)) available++;
+            }
+            if (available < k) {
+                std::cerr << "Rebalance: stripe " << stripe << " of " << file_id << " has only "
+                          << available << " readable units\n";
+                return Outcome::Failed;
+            }
+            std::vector<uint8_t*> ptrs;
+            for (size_t i = 0; i < n; i++) {
+                if (!present[i]) shards[i].assign(len, 0);
+                ptrs.push_back(shards[i].data());
+            }
+            codec.reconstruct(ptrs.data(), present, len, false);
+            for (size_t i : moved) {
+                if (expected && crc32c(shards[i].data(), len) != expected[i]) return Outcome::Failed;
+            }
+        }
+
+        for (size_t i : moved) {
+            limiter_.acquire(len);
+            count_bytes(len);
+            if (!store_unit(next[i], unit_id(file_id, stripe, i, k), shards[i].data(), len)) return Outcome::Failed;
+        }
+        moves.push_back({stripe, std::move(next), std::move(moved)});
+        return Outcome::Moved;
+    }
+
+    void count_bytes(size_t len) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        progress_.bytes += len;
     }
 
-    return recovered_blocks;
+    void save_checkpoint(const std::string& after) {
+        try {
+            replace_file(checkpoint_path_, json{{"version", topology_->version}, {"after", after}}.dump());
+        } catch (const std::exception& e) {
+            std::cerr << "Rebalance checkpoint not saved: " << e.what() << "\n";
+        }
+    }
+
+    std::shared_ptr<const Topology> topology_; // la que se está aplicando
+    std::string checkpoint_path_;
+    RateLimiter limiter_;
+    std::chrono::steady_clock::time_point start_;
+    std::atomic<bool> stop_{false};
+    mutable std::mutex mutex_;
+    Progress progress_;
+    std::thread thread_;
+};
+
+// Sondea GET /status en cada nodo cada health_interval_ms y lleva su estado en NODE_HEALTH.
+// Los sondeos usan conexiones propias con timeout corto (health_timeout_ms), separadas del
+// pool, para que un nodo colgado se descubra aunque las peticiones esperen node_timeout_ms.
+class HealthMonitor {
+public:
+    static constexpr size_t PROBE_PARALLELISM = 32; // nodos que se sondean a la vez
+
+    HealthMonitor() { thread_ = std::thread(&HealthMonitor::loop, this); }
+
+    ~HealthMonitor() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    HealthMonitor(const HealthMonitor&) = delete;
+    HealthMonitor& operator=(const HealthMonitor&) = delete;
+
+private:
+    void loop() {
+        auto interval = std::chrono::milliseconds(CONFIG.health_interval_ms);
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!wake_.wait_for(lock, interval, [this] { return stop_; })) {
+            lock.unlock();
+            probe_all();
+            lock.lock();
+        }
+    }
+
+    void probe_all() {
+        std::shared_ptr<const Topology> nodes = topology();
+        while (clients_.size() < nodes->size()) {
+            auto client = std::make_unique<Client>(nodes->nodes[clients_.size()].url);
+            client->set_keep_alive(true);
+            client->set_connection_timeout(std::chrono::milliseconds(CONFIG.health_timeout_ms));
+            client->set_read_timeout(std::chrono::milliseconds(CONFIG.health_timeout_ms));
+            client->set_write_timeout(std::chrono::milliseconds(CONFIG.health_timeout_ms));
+            clients_.push_back(std::move(client));
+        }
+        for (size_t begin = 0; begin < nodes->size(); begin += PROBE_PARALLELISM) {
+            std::vector<std::thread> probes;
+            for (size_t i = begin; i < std::min(begin + PROBE_PARALLELISM, nodes->size()); i++) {
+                probes.emplace_back([this, i, &nodes] { probe(i, nodes->nodes[i].url); });
+            }
+            for (auto& probe : probes) probe.join();
+        }
+    }
+
+    void probe(size_t node, const std::string& url) {
+        auto start = std::chrono::steady_clock::now();
+        auto res = clients_[node]->Get("/status");
+        bool ok = res && res->status == 200;
+        NodeState before = NODE_HEALTH->record(node, ok, elapsed_ms(start));
+        NodeState after = NODE_HEALTH->state(node);
+        if (after == before) return;
+        if (after == NodeState::Down) {
+            std::cerr << "Node " << url << " is down (" << CONFIG.health_down_after
+                      << " failed heartbeats), reading its units from parity\n";
+        } else if (before == NodeState::Down) {
+            std::cout << "Node " << url << " is up again\n";
+        }
+    }
+
+    std::vector<std::unique_ptr<Client>> clients_; // uno por nodo, solo los usa este hilo
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+// Verificación periódica (scrub) de todas las franjas: lee las k + m unidades de cada franja,
+// comprueba su CRC32C, recalcula la paridad con el codec (kernels SIMD) y la compara con la
+// guardada. Así la corrupción de una paridad se descubre antes de necesitarla. Corre cada
+// scrub_interval_hours (o a pedido con POST /scrub), limitado a scrub_bandwidth_mb, y con
+// scrub_repair reescribe las unidades inconsistentes decodificándolas desde las válidas.
+class ParityScrubber {
+public:
+    // Unidad inconsistente encontrada en una pasada
+    struct Issue {
+        std::string file_id;
+        size_t stripe = 0;
+        size_t unit = 0;
+        size_t node = 0;  // nodo que guarda la unidad
+        std::string kind; // "missing", "checksum" o "parity_mismatch"
+        bool repaired = false;
+    };
+
+    struct Stats {
+        bool running = false;
+        uint64_t passes = 0;           // pasadas completas
+        uint64_t stripes_scanned = 0;
+        uint64_t bytes = 0;
+        uint64_t inconsistencies = 0;
+        uint64_t repaired = 0;
+        uint64_t unrepairable = 0;     // franjas con menos de k unidades válidas
+        uint64_t files_failed = 0;     // archivos que no se pudieron verificar (p. ej. codec desconocido)
+        std::deque<Issue> recent;      // últimas MAX_ISSUES inconsistencias, la más nueva al final
+    };
+
+    static constexpr size_t MAX_ISSUES = 100;
+
+    ParityScrubber() : limiter_(CONFIG.scrub_bandwidth_mb * 1000 * 1000) {
+        thread_ = std::thread(&ParityScrubber::loop, this);
+    }
+
+    ~ParityScrubber() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    ParityScrubber(const ParityScrubber&) = delete;
+    ParityScrubber& operator=(const ParityScrubber&) = delete;
+
+    // Adelanta la próxima pasada; false si ya hay una en curso
+    bool trigger() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stats_.running) return false;
+        requested_ = true;
+        wake_.notify_one();
+        return true;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    void loop() {
+        auto interval = std::chrono::duration<double, std::ratio<3600>>(CONFIG.scrub_interval_hours);
+        auto next = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval);
+        auto woken = [this] { return stop_ || requested_; };
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            // Con intervalo 0 solo corre a pedido
+            if (CONFIG.scrub_interval_hours > 0) wake_.wait_until(lock, next, woken);
+            else wake_.wait(lock, woken);
+            if (stop_) return;
+            requested_ = false;
+            stats_.running = true;
+            lock.unlock();
+            scrub_all();
+            lock.lock();
+            stats_.running = false;
+            next = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval);
+        }
+    }
+
+    void scrub_all() {
+        for (const std::string& file_id : METADATA->file_ids()) {
+            // Un archivo que no se puede verificar no detiene la pasada
+            try {
+                if (!scrub_file(file_id)) return;
+            } catch (const std::exception& e) {
+                std::cerr << "Scrub: " << file_id << " not verified: " << e.what() << "\n";
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.files_failed++;
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.passes++;
+        std::cout << "Scrub pass " << stats_.passes << " finished: " << stats_.inconsistencies
+                  << " inconsistencies so far, " << stats_.repaired << " repaired\n";
+    }
+
+    // Devuelve false si el scrubber se está deteniendo
+    bool scrub_file(const std::string& file_id) {
+        std::optional<FileMetadata> meta = METADATA->get(file_id);
+        if (!meta || meta->layout.stripe_count() == 0) return true;
+        std::shared_ptr<const ErasureCodec> codec = codec_for(*meta);
+        uint64_t version = UINT64_MAX;
+        for (size_t stripe = 0; stripe < meta->layout.stripe_count(); stripe++) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stop_) return false;
+            }
+            FileLock file = lock_stripe(file_id, meta, version);
+            scrub_stripe(*meta, *codec, file_id, stripe);
+        }
+        return true;
+    }
+
+    void scrub_stripe(const FileMetadata& meta, const ErasureCodec& codec, const std::string& file_id, size_t stripe) {
+        const StripeLayout& layout = meta.layout;
+        size_t k = layout.k;
+        size_t n = layout.k + layout.m;
+        size_t len = layout.unit_length(stripe);
+        const uint32_t* expected = stripe_checksums(meta, stripe);
+
+        Blocks shards(n);
+        std::vector<bool> valid(n, false);
+        std::vector<const char*> kind(n, nullptr);
+        for (size_t i = 0; i < n; i++) {
+            limiter_.acquire(len);
+            bool ok = with_node(layout.node(stripe, i), [&](Client& client) {
+                return fetch_block(client, unit_id(file_id, stripe, i, k), shards[i], TRANSPORT);
+            }) && shards[i].size() == len;
+            if (!ok) kind[i] = "missing";
+            else if (expected && crc32c(shards[i].data(), len) != expected[i]) kind[i] = "checksum";
+            else valid[i] = true;
+        }
+
+        // Con los datos válidos, la paridad guardada tiene que coincidir con la recalculada (en
+        // archivos sin CRC no se puede saber qué unidad está mal y se confía en los datos)
+        if (std::all_of(valid.begin(), valid.begin() + k, [](bool v) { return v; })) {
+            Blocks parity(n - k, ByteBlock(len));
+            std::vector<const uint8_t*> data_ptrs;
+            std::vector<uint8_t*> parity_ptrs;
+            for (size_t i = 0; i < k; i++) data_ptrs.push_back(shards[i].data());
+            for (auto& block : parity) parity_ptrs.push_back(block.data());
+            codec.encode(data_ptrs.data(), parity_ptrs.data(), len);
+            for (size_t j = 0; j < n - k; j++) {
+                if (valid[k + j] && parity[j] != shards[k + j]) {
+                    valid[k + j] = false;
+                    kind[k + j] = "parity_mismatch";
+                }
+            }
+        }
+
+        size_t bad = std::count(valid.begin(), valid.end(), false);
+        bool repaired = false;
+        bool repairable = n - bad >= k;
+        if (bad > 0 && repairable && CONFIG.scrub_repair) repaired = repair(meta, codec, file_id, stripe, shards, valid);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.stripes_scanned++;
+        stats_.bytes += n * len;
+        if (bad == 0) return;
+        if (!repairable) stats_.unrepairable++;
+        for (size_t i = 0; i < n; i++) {
+            if (valid[i]) continue;
+            size_t node = layout.node(stripe, i);
+            std::cerr << "Scrub: " << kind[i] << " in " << unit_id(file_id, stripe, i, k) << " on "
+                      << topology()->nodes[node].url << (repaired ? " (repaired)" : "") << "\n";
+            stats_.inconsistencies++;
+            if (repaired) stats_.repaired++;
+            stats_.recent.push_back({file_id, stripe, i, node, kind[i], repaired});
+            if (stats_.recent.size() > MAX_ISSUES) stats_.recent.pop_front();
+        }
+    }
+
+    // Decodifica las unidades no válidas desde las válidas y las vuelve a escribir
+    bool repair(const FileMetadata& meta, const ErasureCodec& codec, const std::string& file_id, size_t stripe,
+                Blocks& shards, const std::vector<bool>& valid) {
+        size_t k = meta.layout.k;
+        size_t n = shards.size();
+        size_t len = meta.layout.unit_length(stripe);
+        const uint32_t* expected = stripe_checksums(meta, stripe);
+
+        std::vector<uint8_t*> ptrs;
+        for (size_t i = 0; i < n; i++) {
+            if (!valid[i]) shards[i].assign(len, 0);
+            ptrs.push_back(shards[i].data());
+        }
+        codec.reconstruct(ptrs.data(), valid, len, false);
+
+        bool all_stored = true;
+        for (size_t i = 0; i < n; i++) {
+            if (valid[i]) continue;
+            if (expected && crc32c(shards[i].data(), len) != expected[i]) return false;
+            limiter_.acquire(len);
+            all_stored &= store_unit(meta.layout.node(stripe, i), unit_id(file_id, stripe, i, k), shards[i].data(), len);
+        }
+        return all_stored;
+    }
+
+    RateLimiter limiter_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool requested_ = false;
+    bool stop_ = false;
+    Stats stats_;
+    std::thread thread_;
+};
+
+std::mutex REBUILD_MUTEX;
+std::unique_ptr<NodeRebuild> REBUILD; // última reconstrucción iniciada (nula si nunca hubo una)
+
+std::string rebuild_checkpoint_path() {
+    return (fs::path(CONFIG.metadata_dir) / "rebuild.json").string();
 }
 
-int main() {
-    Server svr;
+std::unique_ptr<ParityScrubber> SCRUBBER;
+std::unique_ptr<HealthMonitor> HEALTH_MONITOR;
 
-    // upload endpoint
-    svr.Post("/upload", [](const Request& req, Response& res) {
-        // revisa si está vacío
-        if (req.body.empty()) {
-            res.status = 400;
-            res.set_content("Missing file data", "text/plain");
-            return;
+std::mutex REBALANCE_MUTEX;
+std::unique_ptr<Rebalancer> REBALANCE; // último rebalanceo iniciado (nulo si nunca hubo uno)
+
+std::string rebalance_checkpoint_path() {
+    return (fs::path(CONFIG.metadata_dir) / "rebalance.json").string();
+}
+
+std::string node_registry_path() {
+    return (fs::path(CONFIG.metadata_dir) / "nodes.json").string();
+}
+
+// Reemplaza el rebalanceo en curso (si hay) por uno hacia la topología actual
+void start_rebalance(std::string resume_after = "") {
+    std::lock_guard<std::mutex> lock(REBALANCE_MUTEX);
+    REBALANCE.reset();
+    REBALANCE = std::make_unique<Rebalancer>(rebalance_checkpoint_path(), std::move(resume_after));
+}
+
+json rebalance_status() {
+    std::lock_guard<std::mutex> lock(REBALANCE_MUTEX);
+    if (!REBALANCE) return json{{"running", false}};
+    Rebalancer::Progress p = REBALANCE->progress();
+    double throughput = p.elapsed_s > 0 ? p.bytes / p.elapsed_s / (1000 * 1000) : 0;
+    return json{{"topology_version", p.topology_version}, {"running", p.running}, {"error", p.error},
+                {"files_total", p.files_total}, {"files_done", p.files_done},
+                {"stripes_checked", p.stripes_checked}, {"stripes_moved", p.stripes_moved},
+                {"stripes_failed", p.stripes_failed}, {"units_moved", p.units_moved}, {"bytes", p.bytes},
+                {"elapsed_s", p.elapsed_s}, {"throughput_mb_s", throughput}, {"resumed_after", p.resumed_after}};
+}
+
+json nodes_status() {
+    std::shared_ptr<const Topology> nodes = topology();
+    json list = json::array();
+    for (size_t i = 0; i < nodes->size(); i++) {
+        NodeState state = NODE_HEALTH ? NODE_HEALTH->state(i) : NodeState::Up;
+        list.push_back({{"node", i}, {"url", nodes->nodes[i].url}, {"weight", nodes->nodes[i].weight},
+                        {"capacity_gb", nodes->nodes[i].capacity_gb}, {"xml", nodes->nodes[i].from_xml},
+                        {"state", node_state_name(state)}});
+    }
+    return json{{"version", nodes->version}, {"placement", CONFIG.placement}, {"nodes", list}};
+}
+
+// Aplica a la topología los nodos nuevos o con otro peso o capacidad: guarda el registro,
+// publica la nueva topología (las peticiones en curso terminan con la que tomaron) y con
+// placement "hashed" empieza a mudar las franjas. Devuelve el error si no se pudo aplicar.
+std::string update_topology(const std::vector<NodeInfo>& changes) {
+    {
+        std::lock_guard<std::mutex> lock(TOPOLOGY_MUTEX);
+        std::shared_ptr<const Topology> current = topology();
+        NodeRegistry registry{current->version, current->nodes};
+        if (merge_nodes(registry, changes) == 0) return "";
+        std::shared_ptr<const Topology> next;
+        try {
+            next = make_topology(registry.version, registry.nodes, current.get(), current->ring ? current->ring->width() : 0);
+            save_node_registry(node_registry_path(), registry);
+        } catch (const std::exception& e) {
+            return e.what();
+        }
+        for (size_t i = current->size(); i < next->size(); i++) NODE_POOL->add_node(next->nodes[i].url);
+        TOPOLOGY = next;
+        for (const auto& node : changes) {
+            std::cout << "Topology " << next->version << ": " << node.url << " with weight " << node.weight << "\n";
+        }
+    }
+    if (topology()->ring) start_rebalance();
+    return "";
+}
+
+// Firma de los XML de un directorio (nombre, fecha de modificación y tamaño de cada uno)
+std::string node_config_signature(const std::string& dir) {
+    std::vector<std::string> entries;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".xml") continue;
+        auto mtime = fs::last_write_time(entry.path(), ec).time_since_epoch().count();
+        entries.push_back(entry.path().filename().string() + ":" + std::to_string(mtime) + ":" +
+                          std::to_string(fs::file_size(entry.path(), ec)));
+    }
+    std::sort(entries.begin(), entries.end());
+    std::string signature;
+    for (const auto& entry : entries) signature += entry + "\n";
+    return signature;
+}
+
+// Vigila los XML de los Disk Nodes y aplica sus cambios sin reiniciar: un XML nuevo registra
+// el nodo, uno modificado le cambia el peso o la capacidad y uno borrado deja el nodo con
+// peso 0 (se vacía con el rebalanceo; no se quita porque los metadatos guardan su índice).
+// Solo se aplica lo que cambió en los XML, así un peso puesto con POST /nodes se mantiene
+// mientras no se toque el XML de ese nodo. Un XML inválido no cambia nada.
+class NodeConfigWatcher {
+public:
+    NodeConfigWatcher(std::string dir, std::vector<NodeInfo> loaded)
+        : dir_(std::move(dir)), signature_(node_config_signature(dir_)), known_(std::move(loaded)) {
+        thread_ = std::thread(&NodeConfigWatcher::loop, this);
+    }
+
+    ~NodeConfigWatcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    NodeConfigWatcher(const NodeConfigWatcher&) = delete;
+    NodeConfigWatcher& operator=(const NodeConfigWatcher&) = delete;
+
+private:
+    void loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!wake_.wait_for(lock, std::chrono::milliseconds(CONFIG.node_config_reload_ms), [this] { return stop_; })) {
+            lock.unlock();
+            reload();
+            lock.lock();
         }
+    }
 
+    void reload() {
+        std::string signature = node_config_signature(dir_);
+        if (signature == signature_) return;
+        // La firma se guarda solo si la configuración quedó aplicada; si falla se reintenta en la próxima vuelta
+        std::vector<NodeInfo> loaded;
         try {
-            // Convierte el contenido a bytes
-            std::vector<uint8_t> file_data(req.body.begin(), req.body.end());
-            size_t original_size = file_data.size();
+            loaded = load_node_configs(dir_);
+        } catch (const std::exception& e) {
+            std::cerr << "Node configuration not reloaded: " << e.what() << "\n";
+            return;
+        }
+        std::vector<NodeInfo> changes = node_config_changes(known_, loaded);
+        if (!changes.empty()) {
+            if (std::string error = update_topology(changes); !error.empty()) {
+                std::cerr << "Node configuration not applied, keeping topology " << topology()->version << ": " << error << "\n";
+                return;
+            }
+            known_ = std::move(loaded);
+        }
+        signature_ = signature;
+    }
+
+    std::string dir_;
+    std::string signature_;
+    std::vector<NodeInfo> known_; // nodos según los XML que ya se aplicaron
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+std::unique_ptr<NodeConfigWatcher> NODE_CONFIG_WATCHER;
+
+json rebuild_status() {
+    std::lock_guard<std::mutex> lock(REBUILD_MUTEX);
+    if (!REBUILD) return json{{"running", false}};
+    NodeRebuild::Progress p = REBUILD->progress();
+    return json{{"node", p.node}, {"node_url", topology()->nodes[p.node].url}, {"running", p.running},
+                {"error", p.error}, {"files_total", p.files_total}, {"files_done", p.files_done},
+                {"units_checked", p.units_checked}, {"units_rebuilt", p.units_rebuilt},
+                {"units_lost", p.units_lost}, {"bytes", p.bytes}, {"resumed_after", p.resumed_after}};
+}
 
-            // Añade padding si es necesario (para división en 3 bloques)
-            size_t pad = (3 - (original_size % 3)) % 3;
-            file_data.insert(file_data.end(), pad, 0);
+int main(int argc, char** argv) {
+    CONFIG = load_config(argc > 1 ? argv[1] : "controller_config.json");
+    CODEC = make_codec(CONFIG.codec, CONFIG.data_blocks, CONFIG.parity_blocks);
+    TRANSPORT = parse_transport(CONFIG.transport);
+    IO_POOL = std::make_unique<IoPool>(CONFIG.io_threads);
+    ConnectionPool::Options pool_options;
+    pool_options.max_per_node = CONFIG.max_connections_per_node;
+    pool_options.idle_timeout_ms = CONFIG.idle_timeout_ms;
+    pool_options.acquire_timeout_ms = CONFIG.node_timeout_ms;
+    pool_options.connect_timeout_ms = CONFIG.connect_timeout_ms;
+    pool_options.io_timeout_ms = CONFIG.node_timeout_ms;
 
-            // Divide en 3 bloques y distribuye
-            size_t block_size = file_data.size() / 3;
-            Blocks blocks;
-            for (int i = 0; i < 3; i++) {
-                auto start = file_data.begin() + i * block_size;
-                blocks.push_back(ByteBlock(start, start + block_size));
+    // Los nodos salen de los XML de node_config_dir y, si no hay, de "nodes" en el JSON
+    std::vector<NodeInfo> configured;
+    if (!CONFIG.node_config_dir.empty()) configured = load_node_configs(CONFIG.node_config_dir);
+    bool from_xml = !configured.empty();
+    if (!from_xml) {
+        if (!CONFIG.node_config_dir.empty()) {
+            std::cout << "No node XML in '" << CONFIG.node_config_dir << "', using the nodes of the configuration\n";
+        }
+        for (size_t i = 0; i < CONFIG.nodes.size(); i++) configured.push_back({CONFIG.nodes[i], CONFIG.node_weights[i]});
+    }
+
+    // El registro fija el índice de cada nodo entre reinicios; los nodos nuevos de la
+    // configuración se agregan al final como si se hubieran registrado con POST /nodes. Los
+    // XML además mandan sobre el peso y la capacidad de sus nodos, y un nodo cuyo XML se borró
+    // con el controlador detenido se vacía igual que si se hubiera borrado en marcha; con la
+    // lista del JSON se conserva lo que se haya cambiado con POST /nodes.
+    fs::create_directories(CONFIG.metadata_dir);
+    NodeRegistry registry = load_node_registry(node_registry_path());
+    bool first_start = registry.nodes.empty();
+    std::vector<NodeInfo> changes = configured;
+    if (from_xml) {
+        changes = node_config_changes(registry.nodes, configured);
+        for (const auto& node : changes) {
+            if (!node.from_xml) std::cout << "No XML for " << node.url << " anymore, draining it\n";
+        }
+    } else {
+        std::erase_if(changes, [&](const NodeInfo& node) {
+            return std::any_of(registry.nodes.begin(), registry.nodes.end(),
+                               [&](const NodeInfo& other) { return other.url == node.url; });
+        });
+    }
+    bool changed = merge_nodes(registry, changes) > 0 && !first_start;
+    if (registry.nodes.size() < CODEC->data_blocks() + CODEC->parity_blocks()) {
+        throw std::runtime_error("Config needs at least data_blocks + parity_blocks nodes");
+    }
+    if (first_start || changed) save_node_registry(node_registry_path(), registry);
+    size_t ring_width = CONFIG.placement == "hashed" ? CODEC->data_blocks() + CODEC->parity_blocks() : 0;
+    TOPOLOGY = make_topology(registry.version, registry.nodes, nullptr, ring_width);
+    std::vector<std::string> urls;
+    for (const auto& node : registry.nodes) urls.push_back(node.url);
+    NODE_POOL = std::make_unique<ConnectionPool>(urls, pool_options);
+    MetadataStore::Options metadata_options;
+    metadata_options.dir = CONFIG.metadata_dir;
+    metadata_options.compact_bytes = CONFIG.metadata_compact_bytes;
+    METADATA = std::make_unique<MetadataStore>(metadata_options);
+    FILE_IDS = std::make_unique<FileIdGenerator>(static_cast<uint16_t>(CONFIG.instance_id));
+    // Los ids ordenan por tiempo: el último con el formato del generador es el más alto, así
+    // que aunque el reloj haya retrocedido desde el reinicio no se repite ninguno
+    std::vector<std::string> stored_ids = METADATA->file_ids();
+    for (auto it = stored_ids.rbegin(); it != stored_ids.rend(); ++it) {
+        uint64_t id;
+        if (FileIdGenerator::decode_file_id(*it, id)) {
+            FILE_IDS->resume_after(id);
+            break;
+        }
+    }
+    if (CONFIG.dedup) {
+        ChunkIndex::Options chunk_options;
+        chunk_options.dir = CONFIG.metadata_dir;
+        CHUNKS = std::make_unique<ChunkIndex>(chunk_options);
+    }
+
+    if (CONFIG.stripe_cache_mb > 0) {
+        StripeCache::Options cache_options;
+        cache_options.capacity_bytes = CONFIG.stripe_cache_mb * 1024 * 1024;
+        cache_options.expected_entry_bytes = CODEC->data_blocks() * CONFIG.stripe_unit;
+        STRIPE_CACHE = std::make_unique<StripeCache>(cache_options);
+    }
+
+    // Termina las escrituras en sitio que quedaron a medias antes de que arranquen el scrub
+    // y la reconstrucción (verían unidades que no coinciden con sus CRC32C)
+    PATCH_JOURNAL = std::make_unique<PatchJournal>(CONFIG.metadata_dir);
+    for (const auto& pending : PATCH_JOURNAL->pending()) {
+        std::cout << "Replaying update of stripe " << pending.patch.stripe << " of " << pending.patch.file_id << "\n";
+        if (!commit_patch(pending.seq, pending.patch)) {
+            std::cerr << "Stripe " << pending.patch.stripe << " of " << pending.patch.file_id
+                      << " still pending: fewer than k nodes accepted it\n";
+        }
+    }
+
+    // Los sondeos empiezan antes que el scrub y la reconstrucción para que no esperen a los
+    // nodos caídos más que hasta health_down_after sondeos
+    if (CONFIG.health_interval_ms > 0) {
+        NODE_HEALTH = std::make_unique<NodeHealth>(NodeHealth::Options{CONFIG.health_down_after, CONFIG.health_up_after});
+        HEALTH_MONITOR = std::make_unique<HealthMonitor>();
+    }
+
+    SCRUBBER = std::make_unique<ParityScrubber>();
+
+    // Retoma una reconstrucción que no terminó antes de que se detuviera el controlador
+    if (std::string saved = read_file(rebuild_checkpoint_path()); !saved.empty()) {
+        json checkpoint = json::parse(saved);
+        size_t node = checkpoint.at("node").get<size_t>();
+        if (node < topology()->size()) {
+            std::string after = checkpoint.at("after").get<std::string>();
+            std::cout << "Resuming rebuild of " << topology()->nodes[node].url << " after '" << after << "'\n";
+            REBUILD = std::make_unique<NodeRebuild>(node, rebuild_checkpoint_path(), after);
+        }
+    }
+
+    // Retoma el rebalanceo que no terminó (desde el principio si la topología cambió desde
+    // entonces) o empieza uno si la configuración trajo nodos nuevos
+    if (topology()->ring) {
+        if (std::string saved = read_file(rebalance_checkpoint_path()); !saved.empty()) {
+            json checkpoint = json::parse(saved);
+            std::string after;
+            if (checkpoint.at("version").get<uint64_t>() == topology()->version) {
+                after = checkpoint.at("after").get<std::string>();
+            }
+            std::cout << "Resuming rebalance to topology " << topology()->version << " after '" << after << "'\n";
+            start_rebalance(after);
+        } else if (changed) {
+            std::cout << "Nodes changed in the configuration, rebalancing\n";
+            start_rebalance();
+        }
+    }
+
+    if (from_xml && CONFIG.node_config_reload_ms > 0) {
+        NODE_CONFIG_WATCHER = std::make_unique<NodeConfigWatcher>(CONFIG.node_config_dir, configured);
+    }
+
+    Server svr;
+
+    // upload endpoint: el cuerpo se lee por partes, sin esperar a tenerlo completo.
+    // Con ?updatable=1 el archivo se guarda sin deduplicar ni comprimir para admitir PATCH /update
+    svr.Post("/upload", [](const Request& req, Response& res, const ContentReader& content_reader) {
+        try {
+            // Un id ya guardado (p. ej. de otro controlador con la misma instance_id) se descarta
+            std::string file_id = FILE_IDS->next_file_id();
+            while (METADATA->get(file_id)) {
+                std::cerr << "File id " << file_id << " already in use, generating another\n";
+                file_id = FILE_IDS->next_file_id();
             }
+            FileUploader uploader(file_id, req.get_param_value("updatable") == "1");
+            content_reader([&](const char* data, size_t len) {
+                uploader.write(data, len);
+                return true;
+            });
+            FileMetadata meta = uploader.finish();
 
-            std::string file_id = "file_" + std::to_string(time(nullptr));
-            distribute_blocks(blocks, file_id);
-            // Guarda el tamaño original (para eliminar padding después)
-            file_original_sizes[file_id] = original_size;
+            // revisa si está vacío
+            if (meta.size() == 0) {
+                res.status = 400;
+                res.set_content("Missing file data", "text/plain");
+                return;
+            }
+            // Guarda la distribución (para eliminar padding después); vuelve ya escrita en disco
+            METADATA->put(file_id, meta);
+            try {
+                uploader.commit();
+            } catch (const std::exception& e) {
+                // El archivo ya está guardado; solo se pierde la deduplicación de sus chunks
+                std::cerr << "Chunk index not updated for " << file_id << ": " << e.what() << "\n";
+            }
 
             json response;
             response["file_id"] = file_id;
@@ -168,38 +2045,330 @@ int main() {
     // Download endpoint
     svr.Get("/download/:file_id", [](const Request& req, Response& res) {
         std::string file_id = req.path_params.at("file_id");
-        // Reconstruye los bloques (incluso si un nodo falló)
-        Blocks blocks = reconstruct_file(file_id);
-
-        // Combina y elimina el padding
-        std::vector<uint8_t> full_data;
-        for (const auto& block : blocks) {
-            full_data.insert(full_data.end(), block.begin(), block.end());
+        std::optional<FileMetadata> meta = METADATA->get(file_id);
+        if (!meta) {
+            res.status = 404;
+            res.set_content("Original size not found", "text/plain");
+            return;
+        }
+        // Determine content type (default to application/octet-stream)
+        std::string content_type = "application/octet-stream";
+        if (file_id.find(".pdf") != std::string::npos) {
+            content_type = "application/pdf";
         }
 
-        // convert to original size
-        if (file_original_sizes.count(file_id)) {
-            size_t original_size = file_original_sizes[file_id];
-            full_data.resize(original_size);
+        // Reconstruye y envía franja por franja (incluso si un nodo falló). Con Range, httplib
+        // pide solo los rangos solicitados (206, o multipart/byteranges si son varios) y cada
+        // lectura trae únicamente las unidades de datos que los cubren.
+        res.set_header("Accept-Ranges", "bytes");
+        std::shared_ptr<FileReader> reader;
+        try {
+            reader = std::make_shared<FileReader>(file_id, *meta);
+        } catch (const std::exception& e) {
+            res.status = 500;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            return;
+        }
+        res.set_content_provider(
+            meta->size(), content_type,
+            [reader, file_id](size_t offset, size_t length, DataSink& sink) {
+                try {
+                    return reader->read(offset, length, sink);
+                } catch (const std::exception& e) {
+                    std::cerr << "Download of " << file_id << " aborted: " << e.what() << "\n";
+                    return false;
+                }
+            });
+    });
 
-            // Determine content type (default to application/octet-stream)
-            std::string content_type = "application/octet-stream";
-            if (file_id.find(".pdf") != std::string::npos) {
-                content_type = "application/pdf";
-            }
+    // Escritura en sitio: reemplaza los bytes del archivo desde ?offset= con el cuerpo, sin
+    // cambiar su tamaño. Cada franja tocada se actualiza por separado con el candado del archivo
+    // tomado solo mientras tanto (lee y reescribe solo las unidades que cambian y la paridad).
+    // La escritura no es atómica: si falla a la mitad, las franjas anteriores ya quedaron escritas
+    // y el error dice hasta dónde llegó (bytes_applied, offset_reached).
+    svr.Patch("/update/:file_id", [](const Request& req, Response& res) {
+        std::string file_id = req.path_params.at("file_id");
+        size_t offset;
+        try {
+            offset = std::stoull(req.get_param_value("offset"));
+        } catch (const std::exception&) {
+            res.status = 400;
+            res.set_content(json{{"error", "Missing or invalid offset"}}.dump(), "application/json");
+            return;
+        }
+        if (req.body.empty()) {
+            res.status = 400;
+            res.set_content("Missing file data", "text/plain");
+            return;
+        }
 
-            // Devuelve el archivo original
-            res.set_content(
-                std::string(full_data.begin(), full_data.end()),
-                content_type
-            );
-        } else {
+        // El tamaño y updatable no cambian, así que se pueden revisar sin el candado
+        std::optional<FileMetadata> meta = METADATA->get(file_id);
+        if (!meta) {
             res.status = 404;
             res.set_content("Original size not found", "text/plain");
+            return;
+        }
+        if (!meta->updatable) {
+            res.status = 409;
+            res.set_content(json{{"error", "File was not uploaded with updatable=1"}}.dump(), "application/json");
+            return;
+        }
+        if (offset > meta->size() || req.body.size() > meta->size() - offset) {
+            res.status = 416;
+            res.set_content(json{{"error", "Update must stay within the file"}, {"size", meta->size()}}.dump(),
+                            "application/json");
+            return;
+        }
+
+        size_t pos = offset;
+        size_t stripes = 0;
+        try {
+            std::shared_ptr<const ErasureCodec> codec = codec_for(*meta);
+            uint64_t version = UINT64_MAX;
+            auto data = reinterpret_cast<const uint8_t*>(req.body.data());
+            size_t remaining = req.body.size();
+            while (remaining > 0) {
+                FileLock file = lock_stripe(file_id, meta, version);
+                // Primero las franjas de este archivo que no se pudieron terminar antes
+                bool replayed = false;
+                for (const auto& pending : PATCH_JOURNAL->pending(file_id)) {
+                    if (!commit_patch(pending.seq, pending.patch)) {
+                        throw std::runtime_error("A previous update of this file is still pending");
+                    }
+                    replayed = true;
+                }
+                if (replayed) meta = METADATA->get(file_id);
+
+                const StripeLayout& layout = meta->layout;
+                size_t stripe = pos / layout.stripe_width();
+                size_t begin = pos - layout.stripe_offset(stripe);
+                size_t n = std::min(remaining, layout.stripe_length(stripe) - begin);
+                StripePatch patch = prepare_patch(*meta, *codec, file_id, stripe, begin, begin + n, data);
+                uint64_t seq = PATCH_JOURNAL->begin(patch);
+                if (!commit_patch(seq, patch)) {
+                    throw std::runtime_error("Stripe " + std::to_string(stripe) + " reached fewer than " +
+                                             std::to_string(layout.k) + " nodes; it will be retried");
+                }
+                PATCHED_STRIPES++;
+                stripes++;
+                data += n;
+                pos += n;
+                remaining -= n;
+            }
+            json response{{"file_id", file_id}, {"status", "success"}, {"offset", offset},
+                          {"bytes", req.body.size()}, {"stripes", stripes}};
+            res.set_content(response.dump(), "application/json");
+        } catch (const std::exception& e) {
+            res.status = 500;
+            res.set_content(json{{"error", e.what()}, {"stripes_applied", stripes}, {"bytes_applied", pos - offset},
+                                 {"offset_reached", pos}}.dump(),
+                            "application/json");
+        }
+    });
+
+    // Reconstruye en segundo plano las unidades del nodo (índice en "nodes"), p. ej. después de
+    // reemplazar su disco; las descargas siguen funcionando con paridad mientras tanto
+    svr.Post("/rebuild/:node", [](const Request& req, Response& res) {
+        size_t node;
+        try {
+            node = std::stoul(req.path_params.at("node"));
+        } catch (const std::exception&) {
+            node = SIZE_MAX;
+        }
+        if (node >= topology()->size()) {
+            res.status = 400;
+            res.set_content(json{{"error", "Unknown node"}}.dump(), "application/json");
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(REBUILD_MUTEX);
+            if (REBUILD && REBUILD->progress().running) {
+                res.status = 409;
+                res.set_content(json{{"error", "A rebuild is already running"}}.dump(), "application/json");
+                return;
+            }
+            REBUILD.reset();
+            REBUILD = std::make_unique<NodeRebuild>(node, rebuild_checkpoint_path());
+        }
+        res.set_content(rebuild_status().dump(), "application/json");
+    });
+
+    svr.Get("/rebuild", [](const Request&, Response& res) {
+        res.set_content(rebuild_status().dump(), "application/json");
+    });
+
+    // Registra un nodo ({"url": ..., "weight": ..., "capacity_gb": ...}) o cambia el peso o la
+    // capacidad de uno ya registrado; con placement "hashed" empieza a mudar las franjas a la
+    // nueva distribución (peso 0 vacía el nodo)
+    svr.Post("/nodes", [](const Request& req, Response& res) {
+        NodeInfo node;
+        try {
+            json body = json::parse(req.body);
+            node.url = body.at("url").get<std::string>();
+            std::shared_ptr<const Topology> current = topology();
+            if (size_t index = current->find(node.url); index < current->size()) node = current->nodes[index];
+            node.weight = body.value("weight", node.weight);
+            node.capacity_gb = body.value("capacity_gb", node.capacity_gb);
+        } catch (const std::exception&) {
+            node.url.clear();
+        }
+        if (node.url.empty() || node.weight < 0 || node.capacity_gb < 0) {
+            res.status = 400;
+            res.set_content(json{{"error", "Expected {\"url\": ..., \"weight\": >= 0, \"capacity_gb\": >= 0}"}}.dump(),
+                            "application/json");
+            return;
+        }
+        if (std::string error = update_topology({node}); !error.empty()) {
+            res.status = 400;
+            res.set_content(json{{"error", error}}.dump(), "application/json");
+            return;
+        }
+        json response = nodes_status();
+        response["node"] = topology()->find(node.url);
+        res.set_content(response.dump(), "application/json");
+    });
+
+    svr.Get("/nodes", [](const Request&, Response& res) {
+        res.set_content(nodes_status().dump(), "application/json");
+    });
+
+    // Avance del rebalanceo; POST empieza otra pasada (p. ej. para reintentar franjas fallidas)
+    svr.Get("/rebalance", [](const Request&, Response& res) {
+        res.set_content(rebalance_status().dump(), "application/json");
+    });
+
+    svr.Post("/rebalance", [](const Request&, Response& res) {
+        if (!topology()->ring) {
+            res.status = 409;
+            res.set_content(json{{"error", "Rebalancing needs placement \"hashed\""}}.dump(), "application/json");
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(REBALANCE_MUTEX);
+            if (REBALANCE && REBALANCE->progress().running) {
+                res.status = 409;
+                res.set_content(json{{"error", "A rebalance is already running"}}.dump(), "application/json");
+                return;
+            }
+        }
+        start_rebalance();
+        res.set_content(rebalance_status().dump(), "application/json");
+    });
+
+    // Estado del scrub y últimas inconsistencias; POST adelanta la próxima pasada
+    svr.Get("/scrub", [](const Request&, Response& res) {
+        ParityScrubber::Stats stats = SCRUBBER->stats();
+        json issues = json::array();
+        for (const auto& issue : stats.recent) {
+            issues.push_back({{"file_id", issue.file_id}, {"stripe", issue.stripe}, {"unit", issue.unit},
+                              {"node", topology()->nodes[issue.node].url}, {"kind", issue.kind}, {"repaired", issue.repaired}});
+        }
+        json status{{"running", stats.running}, {"passes", stats.passes}, {"stripes_scanned", stats.stripes_scanned},
+                    {"bytes", stats.bytes}, {"inconsistencies", stats.inconsistencies}, {"repaired", stats.repaired},
+                    {"unrepairable", stats.unrepairable}, {"files_failed", stats.files_failed},
+                    {"interval_hours", CONFIG.scrub_interval_hours}, {"repair", CONFIG.scrub_repair}, {"recent", issues}};
+        res.set_content(status.dump(), "application/json");
+    });
+
+    svr.Post("/scrub", [](const Request&, Response& res) {
+        if (!SCRUBBER->trigger()) {
+            res.status = 409;
+            res.set_content(json{{"error", "A scrub pass is already running"}}.dump(), "application/json");
+            return;
+        }
+        res.set_content(json{{"status", "started"}}.dump(), "application/json");
+    });
+
+    // Estado del controlador (kernel de paridad elegido al arrancar)
+    svr.Get("/status", [](const Request&, Response& res) {
+        json status;
+        status["status"] = "running";
+        status["parity_kernel"] = parity_kernel_name();
+        status["gf_kernel"] = gf_kernel_name();
+        status["crc_kernel"] = crc32c_kernel_name();
+        status["codec"] = CODEC->name();
+        status["data_blocks"] = CODEC->data_blocks();
+        status["parity_blocks"] = CODEC->parity_blocks();
+        status["stripe_unit"] = CONFIG.stripe_unit;
+        status["placement"] = CONFIG.placement;
+        status["transport"] = CONFIG.transport;
+        status["hedged_reads"] = HEDGED_READS.load();
+        status["degraded_stripes"] = DEGRADED_STRIPES.load();
+        status["corrupt_units"] = CORRUPT_UNITS.load();
+        status["read_latency_p50_ms"] = READ_LATENCY.percentile(50, 0);
+        status["read_latency_p99_ms"] = READ_LATENCY.percentile(99, 0);
+        ConnectionPool::Stats pool = NODE_POOL->stats();
+        status["pool_hits"] = pool.hits;
+        status["pool_misses"] = pool.misses;
+        status["pool_evictions"] = pool.evictions;
+        status["pool_timeouts"] = pool.timeouts;
+        status["pool_open"] = pool.open;
+        status["pool_idle"] = pool.idle;
+        std::shared_ptr<const Topology> nodes = topology();
+        json node_writes = json::array();
+        for (size_t i = 0; i < nodes->size(); i++) {
+            node_writes.push_back({{"node", nodes->nodes[i].url}, {"weight", nodes->nodes[i].weight},
+                                   {"units", nodes->counters[i]->write_units.load()},
+                                   {"bytes", nodes->counters[i]->write_bytes.load()}});
+        }
+        status["topology_version"] = nodes->version;
+        status["node_writes"] = node_writes;
+        if (NODE_HEALTH) {
+            json health = json::array();
+            std::vector<NodeHealth::NodeStats> probed = NODE_HEALTH->stats();
+            for (size_t i = 0; i < probed.size() && i < nodes->size(); i++) {
+                health.push_back({{"node", nodes->nodes[i].url}, {"state", node_state_name(probed[i].state)},
+                                  {"probes", probed[i].probes}, {"failures", probed[i].failures},
+                                  {"transitions", probed[i].transitions}, {"last_ms", probed[i].last_ms}});
+            }
+            status["node_health"] = health;
+        }
+        status["down_node_skips"] = DOWN_NODE_SKIPS.load();
+        MetadataStore::Stats metadata = METADATA->stats();
+        status["files"] = metadata.files;
+        status["metadata_wal_bytes"] = metadata.wal_bytes;
+        status["metadata_commits"] = metadata.commits;
+        status["metadata_records"] = metadata.records;
+        status["metadata_compactions"] = metadata.compactions;
+        status["dedup"] = CHUNKS != nullptr;
+        if (CHUNKS) {
+            ChunkIndex::Stats chunks = CHUNKS->stats();
+            status["dedup_saved_bytes"] = DEDUP_SAVED_BYTES.load();
+            status["dedup_chunks"] = chunks.chunks;
+            status["dedup_stored_bytes"] = chunks.stored_bytes;
+            status["dedup_references"] = chunks.references;
+            status["dedup_index_bytes_per_chunk"] = chunks.chunks ? chunks.memory_bytes / chunks.chunks : 0;
+        }
+        status["compression"] = CONFIG.compression;
+        status["compressed_stripes"] = COMPRESSED_STRIPES.load();
+        status["compression_saved_bytes"] = COMPRESSION_SAVED_BYTES.load();
+        status["patched_stripes"] = PATCHED_STRIPES.load();
+        status["patch_fallbacks"] = PATCH_FALLBACKS.load();
+        status["patch_node_bytes"] = PATCH_NODE_BYTES.load();
+        status["stripe_cache"] = STRIPE_CACHE != nullptr;
+        if (STRIPE_CACHE) {
+            StripeCache::Stats cache = STRIPE_CACHE->stats();
+            uint64_t lookups = cache.hits + cache.misses;
+            status["stripe_cache_hits"] = cache.hits;
+            status["stripe_cache_misses"] = cache.misses;
+            status["stripe_cache_hit_ratio"] = lookups ? static_cast<double>(cache.hits) / lookups : 0.0;
+            status["stripe_cache_hit_bytes"] = cache.hit_bytes;
+            status["stripe_cache_inserted_bytes"] = cache.inserted_bytes;
+            status["stripe_cache_rejected"] = cache.rejected;
+            status["stripe_cache_evictions"] = cache.evictions;
+            status["stripe_cache_invalidations"] = cache.invalidations;
+            status["stripe_cache_entries"] = cache.entries;
+            status["stripe_cache_bytes"] = cache.bytes;
         }
+        res.set_content(status.dump(), "application/json");
     });
 
-    std::cout << "Controller running on port 8080\n";
-    svr.listen("0.0.0.0", 8080);
+    std::cout << "Parity kernel: " << parity_kernel_name() << ", GF kernel: " << gf_kernel_name()
+              << ", CRC32C kernel: " << crc32c_kernel_name() << "\n";
+    std::cout << "Codec: " << CODEC->name() << " " << CODEC->data_blocks() << "+"
+              << CODEC->parity_blocks() << "\n";
+    std::cout << "Controller running on port " << CONFIG.port << "\n";
+    svr.listen("0.0.0.0", CONFIG.port);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "cpu_features.hpp"
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(PROYECTO_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace {
+
+#if defined(PROYECTO_X86)
+void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+#if defined(_MSC_VER)
+    int out[4];
+    __cpuidex(out, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; i++) regs[i] = static_cast<uint32_t>(out[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Registros que el sistema operativo guarda en cambios de contexto
+uint64_t xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+CpuFeatures detect() {
+    CpuFeatures f;
+#if defined(PROYECTO_X86)
+    uint32_t r[4];
+    cpuid(0, 0, r);
+    uint32_t max_leaf = r[0];
+
+    cpuid(1, 0, r);
+    f.sse2 = (r[3] >> 26) & 1;
+    f.ssse3 = (r[2] >> 9) & 1;
+    f.sse42 = (r[2] >> 20) & 1;
+    bool osxsave = (r[2] >> 27) & 1;
+    bool avx = (r[2] >> 28) & 1;
+
+    uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+    bool os_ymm = (xcr0 & 0x6) == 0x6;    // XMM + YMM
+    bool os_zmm = (xcr0 & 0xe6) == 0xe6;  // XMM + YMM + opmask + ZMM
+
+    if (max_leaf >= 7) {
+        cpuid(7, 0, r);
+        f.avx2 = avx && os_ymm && ((r[1] >> 5) & 1);
+        f.avx512f = os_zmm && ((r[1] >> 16) & 1);
+        f.avx512bw = f.avx512f && ((r[1] >> 30) & 1);
+    }
+#endif
+    return f;
+}
+
+} // namespace
+
+const CpuFeatures& cpu_features() {
+    static const CpuFeatures features = detect();
+    return features;
+}
+
+std::string simd_override() {
+    const char* value = std::getenv("PROYECTO_SIMD");
+    return value ? std::string(value) : std::string();
+}
+
+bool simd_tier_allowed(const char* tier) {
+    static const std::string forced = simd_override();
+    return forced.empty() || forced == tier;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+
+// Detección de instrucciones SIMD en tiempo de ejecución (CPUID)
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PROYECTO_X86 1
+#include <immintrin.h>
+#endif
+
+// Permite compilar cada kernel con su propio set de instrucciones sin flags globales
+#if defined(__GNUC__) || defined(__clang__)
+#define PROYECTO_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PROYECTO_TARGET(isa)
+#endif
+
+struct CpuFeatures {
+    bool sse2 = false;
+    bool ssse3 = false;    // PSHUFB, usado por la multiplicación en GF(2^8)
+    bool sse42 = false;    // instrucción CRC32 (CRC32C por hardware)
+    bool avx2 = false;     // incluye verificación de soporte del SO (XGETBV)
+    bool avx512f = false;
+    bool avx512bw = false; // VPSHUFB de 512 bits
+};
+
+// Se detecta una sola vez; las llamadas siguientes devuelven el mismo resultado
+const CpuFeatures& cpu_features();
+
+// Valor de PROYECTO_SIMD (scalar, sse2, avx2, avx512) para forzar un kernel; vacío si no existe
+std::string simd_override();
+
+// true si PROYECTO_SIMD no está definido o coincide con el nivel pedido
+bool simd_tier_allowed(const char* tier);
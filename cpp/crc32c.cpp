@@ -0,0 +1,133 @@
+#include "crc32c.hpp"
+#include "cpu_features.hpp"
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t POLY = 0x82f63b78; // polinomio de Castagnoli reflejado
+
+using CrcFn = uint32_t (*)(uint32_t, const uint8_t*, size_t);
+
+// Tablas de slicing-by-8: TABLES[j][b] es el CRC del byte b seguido de j bytes en cero
+constexpr std::array<std::array<uint32_t, 256>, 8> make_tables() {
+    std::array<std::array<uint32_t, 256>, 8> t{};
+    for (uint32_t b = 0; b < 256; b++) {
+        uint32_t crc = b;
+        for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (POLY & (0u - (crc & 1)));
+        t[0][b] = crc;
+    }
+    for (int j = 1; j < 8; j++) {
+        for (uint32_t b = 0; b < 256; b++) t[j][b] = (t[j - 1][b] >> 8) ^ t[0][t[j - 1][b] & 0xff];
+    }
+    return t;
+}
+
+constexpr auto TABLES = make_tables();
+
+// Opera sobre el estado sin invertir (las inversiones inicial y final las hace crc32c())
+uint32_t crc32c_scalar(uint32_t crc, const uint8_t* p, size_t len) {
+    for (; len >= 8; p += 8, len -= 8) {
+        uint32_t lo, hi;
+        std::memcpy(&lo, p, 4);
+        std::memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = TABLES[7][lo & 0xff] ^ TABLES[6][(lo >> 8) & 0xff] ^ TABLES[5][(lo >> 16) & 0xff] ^
+              TABLES[4][lo >> 24] ^ TABLES[3][hi & 0xff] ^ TABLES[2][(hi >> 8) & 0xff] ^
+              TABLES[1][(hi >> 16) & 0xff] ^ TABLES[0][hi >> 24];
+    }
+    for (; len > 0; p++, len--) crc = (crc >> 8) ^ TABLES[0][(crc ^ *p) & 0xff];
+    return crc;
+}
+
+// Producto a * b módulo el polinomio (ambos reflejados, x^0 en el bit 31)
+uint32_t multiply_mod(uint32_t a, uint32_t b) {
+    uint32_t product = 0;
+    for (uint32_t mask = 1u << 31; mask != 0; mask >>= 1) {
+        if (a & mask) product ^= b;
+        b = (b >> 1) ^ (POLY & (0u - (b & 1)));
+    }
+    return product;
+}
+
+// x^(8 * bytes): multiplicar un estado por este valor equivale a procesar bytes ceros
+uint32_t zeros_operator(size_t bytes) {
+    uint32_t result = 1u << 31; // 1
+    uint32_t square = 1u << 30; // x
+    for (size_t n = 8 * bytes; n > 0; n >>= 1) {
+        if (n & 1) result = multiply_mod(result, square);
+        square = multiply_mod(square, square);
+    }
+    return result;
+}
+
+#if defined(PROYECTO_X86) && (defined(__x86_64__) || defined(_M_X64))
+// La instrucción CRC32 tiene latencia 3 y rendimiento de una por ciclo: se procesan tres
+// tramos de STREAM bytes a la vez y se combinan desplazando los estados con zeros_operator
+constexpr size_t STREAM = 4096;
+
+PROYECTO_TARGET("sse4.2")
+uint32_t crc32c_sse42(uint32_t crc, const uint8_t* p, size_t len) {
+    static const uint32_t SHIFT1 = zeros_operator(STREAM);
+    static const uint32_t SHIFT2 = zeros_operator(2 * STREAM);
+
+    uint64_t c0 = crc;
+    for (; len >= 3 * STREAM; p += 3 * STREAM, len -= 3 * STREAM) {
+        uint64_t c1 = 0, c2 = 0;
+        for (size_t i = 0; i < STREAM; i += 8) {
+            uint64_t v0, v1, v2;
+            std::memcpy(&v0, p + i, 8);
+            std::memcpy(&v1, p + STREAM + i, 8);
+            std::memcpy(&v2, p + 2 * STREAM + i, 8);
+            c0 = _mm_crc32_u64(c0, v0);
+            c1 = _mm_crc32_u64(c1, v1);
+            c2 = _mm_crc32_u64(c2, v2);
+        }
+        c0 = multiply_mod(static_cast<uint32_t>(c0), SHIFT2) ^ multiply_mod(static_cast<uint32_t>(c1), SHIFT1) ^ c2;
+    }
+    for (; len >= 8; p += 8, len -= 8) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        c0 = _mm_crc32_u64(c0, v);
+    }
+    uint32_t c = static_cast<uint32_t>(c0);
+    for (; len > 0; p++, len--) c = _mm_crc32_u8(c, *p);
+    return c;
+}
+#endif
+
+struct CrcKernel {
+    const char* name;
+    CrcFn fn;
+};
+
+// PROYECTO_SIMD=scalar también desactiva la instrucción CRC32
+CrcKernel select_kernel() {
+#if defined(PROYECTO_X86) && (defined(__x86_64__) || defined(_M_X64))
+    if (simd_override() != "scalar" && cpu_features().sse42) return {"sse4.2", crc32c_sse42};
+#endif
+    return {"scalar", crc32c_scalar};
+}
+
+const CrcKernel& kernel() {
+    static const CrcKernel selected = select_kernel();
+    return selected;
+}
+
+} // namespace
+
+uint32_t crc32c(const uint8_t* data, size_t len, uint32_t crc) {
+    return ~kernel().fn(~crc, data, len);
+}
+
+uint32_t crc32c_combine(uint32_t crc_a, uint32_t crc_b, size_t len_b) {
+    return multiply_mod(crc_a, zeros_operator(len_b)) ^ crc_b;
+}
+
+uint32_t crc32c_zeros(size_t len) {
+    return ~multiply_mod(0xffffffffu, zeros_operator(len));
+}
+
+const char* crc32c_kernel_name() {
+    return kernel().name;
+}
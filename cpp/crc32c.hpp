@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// CRC32C (Castagnoli, el de iSCSI/ext4) para verificar unidades y franjas de extremo a extremo.
+// crc permite continuar un cálculo: crc32c(b, crc32c(a)) == crc32c(a + b).
+uint32_t crc32c(const uint8_t* data, size_t len, uint32_t crc = 0);
+
+// CRC32C de a + b a partir de crc32c(a), crc32c(b) y el largo de b
+uint32_t crc32c_combine(uint32_t crc_a, uint32_t crc_b, size_t len_b);
+
+// CRC32C de len bytes en cero, sin recorrerlos
+uint32_t crc32c_zeros(size_t len);
+
+// Nombre del kernel elegido al arrancar: "sse4.2" o "scalar"
+const char* crc32c_kernel_name();
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "crc32c.hpp"
+
+// Utilidades para los índices persistentes del controlador (metadatos y huellas de chunks):
+// archivos con fsync explícito, registros con crc y proyección en memoria.
+// Los enteros se guardan en el orden de bytes del host (little-endian en x86 y ARM).
+
+template <class T>
+void append_int(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+// Lectura con verificación de límites; un registro truncado lanza std::runtime_error
+class RecordReader {
+public:
+    RecordReader(const uint8_t* data, size_t len) : data_(data), end_(data + len) {}
+
+    template <class T>
+    T read() {
+        need(sizeof(T));
+        T value;
+        std::memcpy(&value, data_, sizeof(T));
+        data_ += sizeof(T);
+        return value;
+    }
+
+    std::string read_string(size_t len) {
+        need(len);
+        std::string s(reinterpret_cast<const char*>(data_), len);
+        data_ += len;
+        return s;
+    }
+
+    size_t remaining() const { return static_cast<size_t>(end_ - data_); }
+
+private:
+    void need(size_t len) const {
+        if (remaining() < len) throw std::runtime_error("Truncated record");
+    }
+
+    const uint8_t* data_;
+    const uint8_t* end_;
+};
+
+// Registros de un log: [u32 largo][u32 crc32c][payload]
+constexpr size_t RECORD_HEADER = 8;
+
+inline void append_record(std::string& out, const std::string& payload) {
+    append_int<uint32_t>(out, static_cast<uint32_t>(payload.size()));
+    append_int<uint32_t>(out, crc32c(reinterpret_cast<const uint8_t*>(payload.data()), payload.size()));
+    out += payload;
+}
+
+// Llama a fn(RecordReader&) con cada registro válido mientras devuelva true. Se detiene en el
+// primer registro incompleto, con crc inválido o truncado (escritura interrumpida) y devuelve
+// cuántos bytes del log son válidos.
+template <class Fn>
+size_t read_records(const std::string& log, Fn fn) {
+    size_t offset = 0;
+    while (offset + RECORD_HEADER <= log.size()) {
+        uint32_t len, crc;
+        std::memcpy(&len, log.data() + offset, 4);
+        std::memcpy(&crc, log.data() + offset + 4, 4);
+        if (len > log.size() - offset - RECORD_HEADER) break;
+        auto payload = reinterpret_cast<const uint8_t*>(log.data() + offset + RECORD_HEADER);
+        if (crc32c(payload, len) != crc) break;
+        try {
+            RecordReader record(payload, len);
+            if (!fn(record)) break;
+        } catch (const std::runtime_error&) {
+            break;
+        }
+        offset += RECORD_HEADER + len;
+    }
+    return offset;
+}
+
+// Lee un archivo completo; vacío si no existe
+std::string read_file(const std::string& path);
+
+// Acceso a archivos con fsync explícito (la API de iostream no lo ofrece); lanzan
+// std::runtime_error si falla la operación
+int open_file(const std::string& path, bool append);
+void write_all(int fd, const std::string& data);
+void sync_file(int fd);
+void truncate_file(int fd);
+void close_file(int fd);
+
+// Escribe data en path de forma atómica: archivo temporal, fsync, rename y fsync del directorio
+void replace_file(const std::string& path, const std::string& data);
+
+// Hace durable un rename dentro del directorio (en Windows no hace falta)
+void sync_dir(const std::string& dir);
+
+// Archivo de solo lectura proyectado en memoria (mmap / MapViewOfFile)
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path); // queda vacío si el archivo no existe
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    void close();
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
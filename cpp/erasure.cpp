@@ -0,0 +1,149 @@
+#include "erasure.hpp"
+#include "gf256.hpp"
+#include "parity.hpp"
+#include <stdexcept>
+
+XorCodec::XorCodec(size_t k) : ErasureCodec(k, 1) {
+    if (k == 0) throw std::runtime_error("xor codec needs at least one data block");
+}
+
+void XorCodec::encode(const uint8_t* const* data, uint8_t* const* parity, size_t len) const {
+    xor_blocks(parity[0], data, k_, len);
+}
+
+void XorCodec::reconstruct(uint8_t* const* shards, const std::vector<bool>& present,
+                           size_t len, bool data_only) const {
+    int missing = -1;
+    for (size_t i = 0; i <= k_; i++) {
+        if (present[i]) continue;
+        if (missing != -1) throw std::runtime_error("More than one block lost");
+        missing = static_cast<int>(i);
+    }
+    if (missing == -1 || (data_only && static_cast<size_t>(missing) == k_)) return;
+
+    // El bloque faltante es el XOR de todos los demás
+    std::vector<const uint8_t*> srcs;
+    for (size_t i = 0; i <= k_; i++) {
+        if (static_cast<int>(i) != missing) srcs.push_back(shards[i]);
+    }
+    xor_blocks(shards[missing], srcs.data(), srcs.size(), len);
+}
+
+void XorCodec::update_parity(size_t, const uint8_t* delta, uint8_t* const* parity, size_t len) const {
+    xor_into(parity[0], delta, len);
+}
+
+ReedSolomonCodec::ReedSolomonCodec(size_t k, size_t m) : ErasureCodec(k, m) {
+    if (k == 0 || m == 0) throw std::runtime_error("rs codec needs k > 0 and m > 0");
+    if (k + m > 256) throw std::runtime_error("rs codec supports at most 256 blocks");
+
+    // Cauchy: 1 / (x_j ^ y_i) con x_j = k + j, y_i = i (conjuntos disjuntos => MDS)
+    matrix_.resize(m * k);
+    for (size_t j = 0; j < m; j++) {
+        for (size_t i = 0; i < k; i++) {
+            matrix_[j * k + i] = gf_inv(static_cast<uint8_t>((k + j) ^ i));
+        }
+    }
+    tables_.resize(matrix_.size() * 32);
+    gf_build_tables(matrix_.data(), matrix_.size(), tables_.data());
+}
+
+void ReedSolomonCodec::encode(const uint8_t* const* data, uint8_t* const* parity, size_t len) const {
+    for (size_t j = 0; j < m_; j++) {
+        gf_dot(parity[j], data, tables_.data() + j * k_ * 32, k_, len);
+    }
+}
+
+// paridad_j ^= coeficiente(j, i) * delta
+void ReedSolomonCodec::update_parity(size_t data_index, const uint8_t* delta, uint8_t* const* parity,
+                                     size_t len) const {
+    for (size_t j = 0; j < m_; j++) {
+        gf_mul_add(parity[j], delta, tables_.data() + (j * k_ + data_index) * 32, len);
+    }
+}
+
+namespace {
+
+// Invierte una matriz n x n sobre GF(2^8) (Gauss-Jordan)
+std::vector<uint8_t> invert_matrix(std::vector<uint8_t> a, size_t n) {
+    std::vector<uint8_t> inv(n * n, 0);
+    for (size_t i = 0; i < n; i++) inv[i * n + i] = 1;
+
+    for (size_t col = 0; col < n; col++) {
+        size_t pivot = col;
+        while (pivot < n && a[pivot * n + col] == 0) pivot++;
+        if (pivot == n) throw std::runtime_error("Singular decode matrix");
+        if (pivot != col) {
+            for (size_t c = 0; c < n; c++) {
+                std::swap(a[pivot * n + c], a[col * n + c]);
+                std::swap(inv[pivot * n + c], inv[col * n + c]);
+            }
+        }
+        uint8_t scale = gf_inv(a[col * n + col]);
+        for (size_t c = 0; c < n; c++) {
+            a[col * n + c] = gf_mul(a[col * n + c], scale);
+            inv[col * n + c] = gf_mul(inv[col * n + c], scale);
+        }
+        for (size_t r = 0; r < n; r++) {
+            uint8_t factor = a[r * n + col];
+            if (r == col || factor == 0) continue;
+            for (size_t c = 0; c < n; c++) {
+                a[r * n + c] ^= gf_mul(factor, a[col * n + c]);
+                inv[r * n + c] ^= gf_mul(factor, inv[col * n + c]);
+            }
+        }
+    }
+    return inv;
+}
+
+} // namespace
+
+void ReedSolomonCodec::reconstruct(uint8_t* const* shards, const std::vector<bool>& present,
+                                   size_t len, bool data_only) const {
+    std::vector<size_t> missing_data;
+    std::vector<size_t> rows; // primeros k shards disponibles
+    for (size_t i = 0; i < k_ + m_; i++) {
+        if (i < k_ && !present[i]) missing_data.push_back(i);
+        if (present[i] && rows.size() < k_) rows.push_back(i);
+    }
+
+    if (!missing_data.empty()) {
+        if (rows.size() < k_) throw std::runtime_error("Not enough blocks to reconstruct");
+
+        // Submatriz de la matriz generadora (identidad + Cauchy) con las filas disponibles
+        std::vector<uint8_t> sub(k_ * k_, 0);
+        for (size_t r = 0; r < k_; r++) {
+            size_t row = rows[r];
+            for (size_t c = 0; c < k_; c++) {
+                sub[r * k_ + c] = row < k_ ? (row == c ? 1 : 0) : matrix_[(row - k_) * k_ + c];
+            }
+        }
+        std::vector<uint8_t> inv = invert_matrix(std::move(sub), k_);
+
+        std::vector<const uint8_t*> srcs;
+        for (size_t row : rows) srcs.push_back(shards[row]);
+        std::vector<uint8_t> coeffs(k_);
+        std::vector<uint8_t> tables(k_ * 32);
+        for (size_t d : missing_data) {
+            for (size_t c = 0; c < k_; c++) coeffs[c] = inv[d * k_ + c];
+            gf_build_tables(coeffs.data(), k_, tables.data());
+            gf_dot(shards[d], srcs.data(), tables.data(), k_, len);
+        }
+    }
+
+    if (data_only) return;
+    // Con los datos completos, las paridades faltantes se recalculan directamente
+    std::vector<const uint8_t*> data(shards, shards + k_);
+    for (size_t j = 0; j < m_; j++) {
+        if (!present[k_ + j]) gf_dot(shards[k_ + j], data.data(), tables_.data() + j * k_ * 32, k_, len);
+    }
+}
+
+std::unique_ptr<ErasureCodec> make_codec(const std::string& name, size_t k, size_t m) {
+    if (name == "xor") {
+        if (m != 1) throw std::runtime_error("xor codec only supports one parity block");
+        return std::make_unique<XorCodec>(k);
+    }
+    if (name == "rs") return std::make_unique<ReedSolomonCodec>(k, m);
+    throw std::runtime_error("Unknown codec: " + name);
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Motor de codificación por borrado: k bloques de datos + m bloques de paridad.
+// Los shards se numeran 0..k-1 (datos) y k..k+m-1 (paridad); todos miden len bytes.
+class ErasureCodec {
+public:
+    ErasureCodec(size_t k, size_t m) : k_(k), m_(m) {}
+    virtual ~ErasureCodec() = default;
+
+    virtual const char* name() const = 0;
+    size_t data_blocks() const { return k_; }
+    size_t parity_blocks() const { return m_; }
+    size_t total_blocks() const { return k_ + m_; }
+
+    // Calcula los m bloques de paridad a partir de los k de datos
+    virtual void encode(const uint8_t* const* data, uint8_t* const* parity, size_t len) const = 0;
+
+    // Reconstruye en sitio los shards con present[i] == false (se necesitan al menos k presentes).
+    // Con data_only solo se recuperan los bloques de datos.
+    virtual void reconstruct(uint8_t* const* shards, const std::vector<bool>& present,
+                             size_t len, bool data_only) const = 0;
+
+    // Actualiza en sitio las m paridades cuando el dato data_index cambia en delta = viejo ^ nuevo
+    // (la paridad es lineal en los datos, así que no hace falta leer los demás bloques)
+    virtual void update_parity(size_t data_index, const uint8_t* delta, uint8_t* const* parity,
+                               size_t len) const = 0;
+
+protected:
+    size_t k_;
+    size_t m_;
+};
+
+// Paridad XOR simple (m = 1), el esquema original del controlador
+class XorCodec : public ErasureCodec {
+public:
+    explicit XorCodec(size_t k);
+    const char* name() const override { return "xor"; }
+    void encode(const uint8_t* const* data, uint8_t* const* parity, size_t len) const override;
+    void reconstruct(uint8_t* const* shards, const std::vector<bool>& present,
+                     size_t len, bool data_only) const override;
+    void update_parity(size_t data_index, const uint8_t* delta, uint8_t* const* parity,
+                       size_t len) const override;
+};
+
+// Reed-Solomon sistemático sobre GF(2^8) con matriz de Cauchy (tolera m pérdidas)
+class ReedSolomonCodec : public ErasureCodec {
+public:
+    ReedSolomonCodec(size_t k, size_t m);
+    const char* name() const override { return "rs"; }
+    void encode(const uint8_t* const* data, uint8_t* const* parity, size_t len) const override;
+    void reconstruct(uint8_t* const* shards, const std::vector<bool>& present,
+                     size_t len, bool data_only) const override;
+    void update_parity(size_t data_index, const uint8_t* delta, uint8_t* const* parity,
+                       size_t len) const override;
+
+    // Coeficiente de la paridad j para el dato i
+    uint8_t coefficient(size_t j, size_t i) const { return matrix_[j * k_ + i]; }
+
+private:
+    std::vector<uint8_t> matrix_; // m x k
+    std::vector<uint8_t> tables_; // tablas PSHUFB precalculadas de matrix_
+};
+
+// "xor" o "rs"; lanza std::runtime_error si la combinación no es válida
+std::unique_ptr<ErasureCodec> make_codec(const std::string& name, size_t k, size_t m);
@@ -0,0 +1,58 @@
+#include "file_id.hpp"
+#include <chrono>
+#include <stdexcept>
+
+FileIdGenerator::FileIdGenerator(uint16_t instance) : instance_(instance) {
+    if (instance >= (1u << INSTANCE_BITS)) {
+        throw std::runtime_error("instance_id must be below " + std::to_string(1u << INSTANCE_BITS));
+    }
+}
+
+uint64_t FileIdGenerator::next() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    uint64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+    // Un reloj anterior a EPOCH_MS daría vuelta al restar; se queda en 0 y crece por secuencia
+    uint64_t ms = now_ms > EPOCH_MS ? now_ms - EPOCH_MS : 0;
+    uint64_t fresh = ms << SEQUENCE_BITS;
+
+    // La secuencia que desborda pasa al bit del milisegundo, así el valor sigue creciendo
+    uint64_t last = last_.load(std::memory_order_relaxed);
+    uint64_t value;
+    do {
+        value = fresh > last ? fresh : last + 1;
+    } while (!last_.compare_exchange_weak(last, value, std::memory_order_relaxed));
+
+    uint64_t sequence = value & ((1ULL << SEQUENCE_BITS) - 1);
+    uint64_t timestamp = value >> SEQUENCE_BITS;
+    return (timestamp << (INSTANCE_BITS + SEQUENCE_BITS)) | (instance_ << SEQUENCE_BITS) | sequence;
+}
+
+void FileIdGenerator::resume_after(uint64_t id) {
+    uint64_t value = ((id >> (INSTANCE_BITS + SEQUENCE_BITS)) << SEQUENCE_BITS) | (id & ((1ULL << SEQUENCE_BITS) - 1));
+    uint64_t last = last_.load(std::memory_order_relaxed);
+    while (last < value && !last_.compare_exchange_weak(last, value, std::memory_order_relaxed)) {
+    }
+}
+
+std::string FileIdGenerator::encode(uint64_t id) {
+    static const char ALPHABET[] = "0123456789abcdefghjkmnpqrstvwxyz";
+    std::string out(13, '0');
+    for (int i = 12; i >= 0; i--) {
+        out[i] = ALPHABET[id & 31];
+        id >>= 5;
+    }
+    return out;
+}
+
+bool FileIdGenerator::decode_file_id(const std::string& file_id, uint64_t& id) {
+    static const std::string ALPHABET = "0123456789abcdefghjkmnpqrstvwxyz";
+    if (file_id.size() != 18 || file_id.compare(0, 5, "file_") != 0) return false;
+    id = 0;
+    for (size_t i = 5; i < file_id.size(); i++) {
+        size_t digit = ALPHABET.find(file_id[i]);
+        // 13 caracteres son 65 bits: el primero lleva solo los 4 más altos
+        if (digit == std::string::npos || (i == 5 && digit >= 16)) return false;
+        id = (id << 5) | digit;
+    }
+    return true;
+}
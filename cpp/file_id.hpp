@@ -0,0 +1,36 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Generador de ids de 64 bits únicos y ordenados aproximadamente por tiempo, sin candados:
+//   [41 bits ms desde 2025-01-01][10 bits instancia del controlador][12 bits secuencia]
+// Si en un mismo milisegundo se agotan las 4096 secuencias, el id toma el milisegundo
+// siguiente en vez de esperar; si el reloj retrocede se sigue desde el último usado, también
+// entre reinicios si al arrancar se pasa el id más alto ya guardado a resume_after.
+class FileIdGenerator {
+public:
+    static constexpr unsigned INSTANCE_BITS = 10;
+    static constexpr unsigned SEQUENCE_BITS = 12;
+    static constexpr uint64_t EPOCH_MS = 1735689600000ULL; // 2025-01-01T00:00:00Z
+
+    explicit FileIdGenerator(uint16_t instance); // lanza si instance no cabe en INSTANCE_BITS
+
+    uint64_t next();
+
+    // Los ids siguientes serán mayores que id aunque el reloj esté por detrás de él
+    void resume_after(uint64_t id);
+
+    // "file_" + 13 caracteres base32 (Crockford) de ancho fijo: el orden de los textos es
+    // el orden numérico, así que el índice de metadatos queda ordenado por tiempo
+    std::string next_file_id() { return "file_" + encode(next()); }
+
+    static std::string encode(uint64_t id);
+
+    // Inverso de next_file_id; false si el texto no tiene ese formato (p. ej. ids anteriores)
+    static bool decode_file_id(const std::string& file_id, uint64_t& id);
+
+private:
+    uint64_t instance_;
+    std::atomic<uint64_t> last_{0}; // (ms << SEQUENCE_BITS) | secuencia del último id
+};
@@ -0,0 +1,216 @@
+#include "gf256.hpp"
+#include "cpu_features.hpp"
+#include <cstring>
+
+namespace {
+
+// Tablas de logaritmos/exponentes, generador 2
+struct GfTables {
+    uint8_t exp[512];
+    uint8_t log[256];
+    GfTables() {
+        unsigned x = 1;
+        for (int i = 0; i < 255; i++) {
+            exp[i] = static_cast<uint8_t>(x);
+            log[x] = static_cast<uint8_t>(i);
+            x <<= 1;
+            if (x & 0x100) x ^= 0x11D;
+        }
+        for (int i = 255; i < 512; i++) exp[i] = exp[i - 255];
+        log[0] = 0;
+    }
+};
+
+const GfTables& gf() {
+    static const GfTables tables;
+    return tables;
+}
+
+using DotFn = void (*)(uint8_t*, const uint8_t* const*, const uint8_t*, size_t, size_t, bool);
+
+void gf_dot_scalar(uint8_t* dst, const uint8_t* const* srcs, const uint8_t* tables,
+                   size_t count, size_t len, bool accumulate) {
+    if (!accumulate) std::memset(dst, 0, len);
+    for (size_t s = 0; s < count; s++) {
+        const uint8_t* lo = tables + 32 * s;
+        const uint8_t* hi = lo + 16;
+        const uint8_t* src = srcs[s];
+        for (size_t i = 0; i < len; i++) {
+            dst[i] ^= lo[src[i] & 0x0f] ^ hi[src[i] >> 4];
+        }
+    }
+}
+
+// Copia de la cola (menos de un vector) al kernel escalar
+void scalar_tail(uint8_t* dst, const uint8_t* const* srcs, const uint8_t* tables,
+                 size_t count, size_t offset, size_t len, bool accumulate) {
+    if (offset >= len) return;
+    for (size_t s = 0; s < count; s++) {
+        const uint8_t* lo = tables + 32 * s;
+        const uint8_t* hi = lo + 16;
+        for (size_t i = offset; i < len; i++) {
+            uint8_t v = lo[srcs[s][i] & 0x0f] ^ hi[srcs[s][i] >> 4];
+            if (s == 0 && !accumulate) dst[i] = v;
+            else dst[i] ^= v;
+        }
+    }
+    if (count == 0 && !accumulate) std::memset(dst + offset, 0, len - offset);
+}
+
+#if defined(PROYECTO_X86)
+PROYECTO_TARGET("ssse3")
+void gf_dot_ssse3(uint8_t* dst, const uint8_t* const* srcs, const uint8_t* tables,
+                  size_t count, size_t len, bool accumulate) {
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m128i a0, a1;
+        if (accumulate) {
+            a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i + 16));
+        } else {
+            a0 = _mm_setzero_si128();
+            a1 = _mm_setzero_si128();
+        }
+        for (size_t s = 0; s < count; s++) {
+            __m128i tlo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables + 32 * s));
+            __m128i thi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables + 32 * s + 16));
+            __m128i x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcs[s] + i));
+            __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcs[s] + i + 16));
+            a0 = _mm_xor_si128(a0, _mm_xor_si128(
+                _mm_shuffle_epi8(tlo, _mm_and_si128(x0, mask)),
+                _mm_shuffle_epi8(thi, _mm_and_si128(_mm_srli_epi64(x0, 4), mask))));
+            a1 = _mm_xor_si128(a1, _mm_xor_si128(
+                _mm_shuffle_epi8(tlo, _mm_and_si128(x1, mask)),
+                _mm_shuffle_epi8(thi, _mm_and_si128(_mm_srli_epi64(x1, 4), mask))));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), a0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16), a1);
+    }
+    scalar_tail(dst, srcs, tables, count, i, len, accumulate);
+}
+
+PROYECTO_TARGET("avx2")
+void gf_dot_avx2(uint8_t* dst, const uint8_t* const* srcs, const uint8_t* tables,
+                 size_t count, size_t len, bool accumulate) {
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m256i a0, a1;
+        if (accumulate) {
+            a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i + 32));
+        } else {
+            a0 = _mm256_setzero_si256();
+            a1 = _mm256_setzero_si256();
+        }
+        for (size_t s = 0; s < count; s++) {
+            __m256i tlo = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables + 32 * s)));
+            __m256i thi = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables + 32 * s + 16)));
+            __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcs[s] + i));
+            __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcs[s] + i + 32));
+            a0 = _mm256_xor_si256(a0, _mm256_xor_si256(
+                _mm256_shuffle_epi8(tlo, _mm256_and_si256(x0, mask)),
+                _mm256_shuffle_epi8(thi, _mm256_and_si256(_mm256_srli_epi64(x0, 4), mask))));
+            a1 = _mm256_xor_si256(a1, _mm256_xor_si256(
+                _mm256_shuffle_epi8(tlo, _mm256_and_si256(x1, mask)),
+                _mm256_shuffle_epi8(thi, _mm256_and_si256(_mm256_srli_epi64(x1, 4), mask))));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), a0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 32), a1);
+    }
+    scalar_tail(dst, srcs, tables, count, i, len, accumulate);
+}
+
+PROYECTO_TARGET("avx512f,avx512bw")
+void gf_dot_avx512(uint8_t* dst, const uint8_t* const* srcs, const uint8_t* tables,
+                   size_t count, size_t len, bool accumulate) {
+    const __m512i mask = _mm512_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 128 <= len; i += 128) {
+        __m512i a0, a1;
+        if (accumulate) {
+            a0 = _mm512_loadu_si512(dst + i);
+            a1 = _mm512_loadu_si512(dst + i + 64);
+        } else {
+            a0 = _mm512_setzero_si512();
+            a1 = _mm512_setzero_si512();
+        }
+        for (size_t s = 0; s < count; s++) {
+            __m512i tlo = _mm512_broadcast_i32x4(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables + 32 * s)));
+            __m512i thi = _mm512_broadcast_i32x4(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables + 32 * s + 16)));
+            __m512i x0 = _mm512_loadu_si512(srcs[s] + i);
+            __m512i x1 = _mm512_loadu_si512(srcs[s] + i + 64);
+            a0 = _mm512_xor_si512(a0, _mm512_xor_si512(
+                _mm512_shuffle_epi8(tlo, _mm512_and_si512(x0, mask)),
+                _mm512_shuffle_epi8(thi, _mm512_and_si512(_mm512_srli_epi64(x0, 4), mask))));
+            a1 = _mm512_xor_si512(a1, _mm512_xor_si512(
+                _mm512_shuffle_epi8(tlo, _mm512_and_si512(x1, mask)),
+                _mm512_shuffle_epi8(thi, _mm512_and_si512(_mm512_srli_epi64(x1, 4), mask))));
+        }
+        _mm512_storeu_si512(dst + i, a0);
+        _mm512_storeu_si512(dst + i + 64, a1);
+    }
+    scalar_tail(dst, srcs, tables, count, i, len, accumulate);
+}
+#endif
+
+struct DotKernel {
+    const char* name;
+    DotFn fn;
+};
+
+DotKernel select_kernel() {
+    const CpuFeatures& cpu = cpu_features();
+#if defined(PROYECTO_X86)
+    if (simd_tier_allowed("avx512") && cpu.avx512bw) return {"avx512", gf_dot_avx512};
+    if (simd_tier_allowed("avx2") && cpu.avx2) return {"avx2", gf_dot_avx2};
+    if (simd_tier_allowed("sse2") && cpu.ssse3) return {"ssse3", gf_dot_ssse3};
+#endif
+    (void)cpu;
+    return {"scalar", gf_dot_scalar};
+}
+
+const DotKernel& kernel() {
+    static const DotKernel selected = select_kernel();
+    return selected;
+}
+
+} // namespace
+
+uint8_t gf_mul(uint8_t a, uint8_t b) {
+    if (a == 0 || b == 0) return 0;
+    const GfTables& t = gf();
+    return t.exp[t.log[a] + t.log[b]];
+}
+
+uint8_t gf_inv(uint8_t a) {
+    const GfTables& t = gf();
+    return t.exp[255 - t.log[a]];
+}
+
+void gf_build_tables(const uint8_t* coeffs, size_t count, uint8_t* tables) {
+    for (size_t s = 0; s < count; s++) {
+        uint8_t* out = tables + 32 * s;
+        for (int x = 0; x < 16; x++) {
+            out[x] = gf_mul(coeffs[s], static_cast<uint8_t>(x));
+            out[16 + x] = gf_mul(coeffs[s], static_cast<uint8_t>(x << 4));
+        }
+    }
+}
+
+void gf_dot(uint8_t* dst, const uint8_t* const* srcs, const uint8_t* tables, size_t count, size_t len) {
+    kernel().fn(dst, srcs, tables, count, len, false);
+}
+
+void gf_mul_add(uint8_t* dst, const uint8_t* src, const uint8_t* table, size_t len) {
+    kernel().fn(dst, &src, table, 1, len, true);
+}
+
+const char* gf_kernel_name() {
+    return kernel().name;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Aritmética en GF(2^8) con polinomio 0x11D (el usual en Reed-Solomon para almacenamiento)
+uint8_t gf_mul(uint8_t a, uint8_t b);
+uint8_t gf_inv(uint8_t a); // a != 0
+
+// Tablas "split" para PSHUFB: 16 productos del nibble bajo + 16 del nibble alto.
+// Escribe 32 bytes por coeficiente en tables.
+void gf_build_tables(const uint8_t* coeffs, size_t count, uint8_t* tables);
+
+// dst = sum(coeffs[s] * srcs[s]) usando las tablas de gf_build_tables
+void gf_dot(uint8_t* dst, const uint8_t* const* srcs, const uint8_t* tables, size_t count, size_t len);
+
+// dst ^= c * src (con las 32 bytes de tabla de c)
+void gf_mul_add(uint8_t* dst, const uint8_t* src, const uint8_t* table, size_t len);
+
+// "avx512", "avx2", "ssse3" o "scalar"
+const char* gf_kernel_name();
@@ -0,0 +1,27 @@
+#pragma once
+#include <future>
+#include <memory>
+#include "httplib.h"
+
+// Hilos compartidos para la E/S con los Disk Nodes (reutiliza el ThreadPool de httplib).
+// Las tareas solo hacen E/S y nunca esperan a otras tareas del mismo pool.
+class IoPool {
+public:
+    explicit IoPool(size_t threads) : pool_(threads) {}
+    ~IoPool() { pool_.shutdown(); }
+
+    IoPool(const IoPool&) = delete;
+    IoPool& operator=(const IoPool&) = delete;
+
+    template <class F>
+    auto submit(F fn) -> std::future<decltype(fn())> {
+        using Result = decltype(fn());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(fn));
+        auto future = task->get_future();
+        pool_.enqueue([task] { (*task)(); });
+        return future;
+    }
+
+private:
+    httplib::ThreadPool pool_;
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+// Ventana de las últimas latencias observadas (ms) para calcular percentiles
+class LatencyTracker {
+public:
+    explicit LatencyTracker(size_t window = 1024) : samples_(window, 0.0) {}
+
+    void record(double ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        samples_[next_] = ms;
+        next_ = (next_ + 1) % samples_.size();
+        count_ = std::min(count_ + 1, samples_.size());
+    }
+
+    // Percentil p (0-100) de la ventana; fallback si aún no hay suficientes muestras
+    double percentile(double p, double fallback) const {
+        std::vector<double> sorted;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (count_ < 16) return fallback;
+            sorted.assign(samples_.begin(), samples_.begin() + count_);
+        }
+        size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p / 100.0 * sorted.size()));
+        std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+        return sorted[index];
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<double> samples_;
+    size_t next_ = 0;
+    size_t count_ = 0;
+};
+
+inline double elapsed_ms(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
@@ -0,0 +1,423 @@
+#include "metadata_store.hpp"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+#include "durable_file.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Formato en disco (ver durable_file.hpp):
+//   wal.log:      registros [u8 op][u64 seq][u16 largo id][id][metadatos]
+//   snapshot-<seq>.bin: cabecera | índice ordenado por id | ids y metadatos
+//     cabecera: "P3META01" u32 versión, u32 reservado, u64 entradas, u64 último seq incluido
+//     entrada:  u64 offset id, u64 offset metadatos, u32 largo id, u32 largo metadatos
+constexpr char SNAPSHOT_MAGIC[8] = {'P', '3', 'M', 'E', 'T', 'A', '0', '1'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr size_t SNAPSHOT_HEADER = 32;
+constexpr size_t SNAPSHOT_ENTRY = 24;
+constexpr uint8_t OP_PUT = 1;
+
+void encode_meta(std::string& out, const FileMetadata& meta) {
+    append_int<uint64_t>(out, meta.layout.file_size);
+    append_int<uint32_t>(out, static_cast<uint32_t>(meta.layout.k));
+    append_int<uint32_t>(out, static_cast<uint32_t>(meta.layout.m));
+    append_int<uint64_t>(out, meta.layout.stripe_unit);
+    append_int<uint16_t>(out, static_cast<uint16_t>(meta.codec.size()));
+    out += meta.codec;
+    append_int<uint32_t>(out, static_cast<uint32_t>(meta.checksums.size()));
+    for (uint32_t checksum : meta.checksums) append_int<uint32_t>(out, checksum);
+    append_int<uint32_t>(out, static_cast<uint32_t>(meta.extents.size()));
+    for (const auto& extent : meta.extents) {
+        append_int<uint16_t>(out, static_cast<uint16_t>(extent.container.size()));
+        out += extent.container;
+        append_int<uint64_t>(out, extent.offset);
+        append_int<uint64_t>(out, extent.length);
+    }
+    append_int<uint32_t>(out, static_cast<uint32_t>(meta.layout.encodings.size()));
+    for (const auto& encoding : meta.layout.encodings) {
+        append_int<uint8_t>(out, static_cast<uint8_t>(encoding.compression));
+        append_int<uint64_t>(out, encoding.stored_length);
+    }
+    append_int<uint32_t>(out, static_cast<uint32_t>(meta.stripe_checksums.size()));
+    for (uint32_t checksum : meta.stripe_checksums) append_int<uint32_t>(out, checksum);
+    append_int<uint8_t>(out, meta.updatable ? 1 : 0);
+    append_int<uint8_t>(out, static_cast<uint8_t>(meta.layout.placement));
+    append_int<uint32_t>(out, static_cast<uint32_t>(meta.layout.stripe_nodes.size()));
+    for (uint16_t node : meta.layout.stripe_nodes) append_int<uint16_t>(out, node);
+}
+
+FileMetadata decode_meta(RecordReader& in) {
+    FileMetadata meta;
+    meta.layout.file_size = in.read<uint64_t>();
+    meta.layout.k = in.read<uint32_t>();
+    meta.layout.m = in.read<uint32_t>();
+    meta.layout.stripe_unit = in.read<uint64_t>();
+    meta.codec = in.read_string(in.read<uint16_t>());
+    uint32_t count = in.read<uint32_t>();
+    meta.checksums.reserve(count);
+    for (uint32_t i = 0; i < count; i++) meta.checksums.push_back(in.read<uint32_t>());
+    if (in.remaining() == 0) return meta; // registro anterior a la deduplicación
+    uint32_t extents = in.read<uint32_t>();
+    meta.extents.reserve(extents);
+    for (uint32_t i = 0; i < extents; i++) {
+        Extent extent;
+        extent.container = in.read_string(in.read<uint16_t>());
+        extent.offset = in.read<uint64_t>();
+        extent.length = in.read<uint64_t>();
+        meta.extents.push_back(std::move(extent));
+    }
+    if (in.remaining() == 0) return meta; // registro anterior a la compresión
+    uint32_t encodings = in.read<uint32_t>();
+    meta.layout.encodings.reserve(encodings);
+    for (uint32_t i = 0; i < encodings; i++) {
+        StripeEncoding encoding;
+        encoding.compression = static_cast<StripeCompression>(in.read<uint8_t>());
+        encoding.stored_length = in.read<uint64_t>();
+        meta.layout.encodings.push_back(encoding);
+    }
+    if (in.remaining() == 0) return meta; // registro anterior a las sumas de verificación
+    count = in.read<uint32_t>();
+    meta.stripe_checksums.reserve(count);
+    for (uint32_t i = 0; i < count; i++) meta.stripe_checksums.push_back(in.read<uint32_t>());
+    if (in.remaining() == 0) return meta; // registro anterior a las escrituras en sitio
+    meta.updatable = in.read<uint8_t>() != 0;
+    if (in.remaining() == 0) return meta; // registro anterior a la paridad rotativa
+    meta.layout.placement = static_cast<Placement>(in.read<uint8_t>());
+    if (in.remaining() == 0) return meta; // registro anterior al anillo de nodos
+    count = in.read<uint32_t>();
+    meta.layout.stripe_nodes.reserve(count);
+    for (uint32_t i = 0; i < count; i++) meta.layout.stripe_nodes.push_back(in.read<uint16_t>());
+    return meta;
+}
+
+struct SnapshotEntry {
+    std::string_view key;
+    std::string_view value;
+};
+
+std::string snapshot_name(uint64_t seq) {
+    std::string digits = std::to_string(seq);
+    return "snapshot-" + std::string(20 - digits.size(), '0') + digits + ".bin";
+}
+
+// Devuelve el seq de un nombre snapshot-<seq>.bin, o nullopt si no es un snapshot
+std::optional<uint64_t> snapshot_seq(const std::string& name) {
+    const std::string prefix = "snapshot-", suffix = ".bin";
+    if (name.size() != prefix.size() + 20 + suffix.size()) return std::nullopt;
+    if (name.compare(0, prefix.size(), prefix) != 0 || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return std::nullopt;
+    }
+    std::string digits = name.substr(prefix.size(), 20);
+    if (digits.find_first_not_of("0123456789") != std::string::npos) return std::nullopt;
+    return std::stoull(digits);
+}
+
+} // namespace
+
+struct MetadataStore::Snapshot {
+    std::string path;
+    MappedFile file;
+    size_t count = 0;
+    uint64_t seq = 0;
+
+    Snapshot() = default;
+
+    // Proyecta y valida la cabecera; un snapshot dañado lanza std::runtime_error
+    explicit Snapshot(std::string snapshot_path) : path(std::move(snapshot_path)), file(path) {
+        if (file.size() < SNAPSHOT_HEADER || std::memcmp(file.data(), SNAPSHOT_MAGIC, 8) != 0) {
+            throw std::runtime_error("Corrupt metadata snapshot " + path);
+        }
+        RecordReader in(file.data() + 8, SNAPSHOT_HEADER - 8);
+        uint32_t version = in.read<uint32_t>();
+        in.read<uint32_t>();
+        count = in.read<uint64_t>();
+        seq = in.read<uint64_t>();
+        if (version != SNAPSHOT_VERSION) throw std::runtime_error("Unsupported metadata snapshot version");
+        if (count > (file.size() - SNAPSHOT_HEADER) / SNAPSHOT_ENTRY) {
+            throw std::runtime_error("Corrupt metadata snapshot " + path);
+        }
+    }
+
+    SnapshotEntry entry(size_t i) const {
+        RecordReader in(file.data() + SNAPSHOT_HEADER + i * SNAPSHOT_ENTRY, SNAPSHOT_ENTRY);
+        uint64_t key_offset = in.read<uint64_t>();
+        uint64_t value_offset = in.read<uint64_t>();
+        uint32_t key_len = in.read<uint32_t>();
+        uint32_t value_len = in.read<uint32_t>();
+        if (key_offset + key_len > file.size() || value_offset + value_len > file.size()) {
+            throw std::runtime_error("Corrupt metadata snapshot entry in " + path);
+        }
+        const char* base = reinterpret_cast<const char*>(file.data());
+        return {{base + key_offset, key_len}, {base + value_offset, value_len}};
+    }
+
+    // Búsqueda binaria sobre el índice ordenado, directamente en el archivo proyectado
+    std::optional<SnapshotEntry> lookup(const std::string& file_id) const {
+        size_t lo = 0, hi = count;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            SnapshotEntry e = entry(mid);
+            if (e.key == file_id) return e;
+            if (e.key < file_id) lo = mid + 1;
+            else hi = mid;
+        }
+        return std::nullopt;
+    }
+
+    std::optional<FileMetadata> find(const std::string& file_id) const {
+        auto e = lookup(file_id);
+        if (!e) return std::nullopt;
+        RecordReader in(reinterpret_cast<const uint8_t*>(e->value.data()), e->value.size());
+        return decode_meta(in);
+    }
+};
+
+MetadataStore::MetadataStore(Options options) : options_(std::move(options)) {
+    fs::create_directories(options_.dir);
+    wal_path_ = (fs::path(options_.dir) / "wal.log").string();
+
+    load_snapshot();
+    uint64_t snapshot_seq = snapshot_.load()->seq;
+    files_ = snapshot_.load()->count;
+    next_seq_ = applied_seq_ = snapshot_seq;
+    replay_wal();
+    durable_seq_ = next_seq_;
+
+    wal_fd_ = open_file(wal_path_, true);
+    flusher_ = std::thread(&MetadataStore::flush_loop, this);
+}
+
+MetadataStore::~MetadataStore() {
+    {
+        std::lock_guard<std::mutex> lock(log_mutex_);
+        stop_ = true;
+    }
+    log_ready_.notify_one();
+    flusher_.join();
+    close_file(wal_fd_);
+}
+
+// Usa el snapshot con mayor seq y borra los anteriores (y temporales de una compactación
+// interrumpida); si no hay ninguno el índice empieza vacío
+void MetadataStore::load_snapshot() {
+    std::vector<std::pair<uint64_t, fs::path>> found;
+    for (const auto& item : fs::directory_iterator(options_.dir)) {
+        std::string name = item.path().filename().string();
+        if (auto seq = snapshot_seq(name)) found.emplace_back(*seq, item.path());
+        else if (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0) fs::remove(item.path());
+    }
+    std::sort(found.begin(), found.end());
+
+    if (found.empty()) {
+        snapshot_ = std::make_shared<const Snapshot>();
+        return;
+    }
+    snapshot_ = std::make_shared<const Snapshot>(found.back().second.string());
+    found.pop_back();
+    for (const auto& old : found) fs::remove(old.second);
+}
+
+// Aplica los registros del log posteriores al snapshot. Un registro incompleto o con crc
+// inválido (escritura interrumpida) marca el final del log y se descarta.
+void MetadataStore::replay_wal() {
+    std::string log = read_file(wal_path_);
+    uint64_t snapshot_seq = snapshot_.load()->seq;
+    size_t valid = read_records(log, [&](RecordReader& record) {
+        if (record.read<uint8_t>() != OP_PUT) return false;
+        uint64_t seq = record.read<uint64_t>();
+        std::string file_id = record.read_string(record.read<uint16_t>());
+        FileMetadata meta = decode_meta(record);
+        next_seq_ = std::max(next_seq_, seq);
+        if (seq > snapshot_seq) {
+            remember(file_id, std::move(meta));
+            applied_seq_ = std::max(applied_seq_, seq);
+        }
+        return true;
+    });
+
+    if (valid < log.size()) {
+        std::cerr << "Discarding " << log.size() - valid << " bytes of incomplete metadata log\n";
+        fs::resize_file(wal_path_, valid);
+    }
+    wal_bytes_ = valid;
+}
+
+void MetadataStore::put(const std::string& file_id, const FileMetadata& meta) {
+    if (file_id.size() > UINT16_MAX) throw std::runtime_error("File id too long");
+    std::unique_lock<std::mutex> lock(log_mutex_);
+    if (failed_) throw std::runtime_error("Metadata log is unavailable");
+    uint64_t seq = ++next_seq_;
+    pending_.push_back({seq, file_id, meta});
+    log_ready_.notify_one();
+    committed_.wait(lock, [&] { return durable_seq_ >= seq || failed_; });
+    if (durable_seq_ < seq) throw std::runtime_error("Could not persist metadata for " + file_id);
+}
+
+// Escribe en un solo fsync todo lo que se acumuló mientras se sincronizaba el lote anterior
+void MetadataStore::flush_loop() {
+    std::unique_lock<std::mutex> lock(log_mutex_);
+    while (true) {
+        log_ready_.wait(lock, [&] { return stop_ || !pending_.empty(); });
+        if (pending_.empty()) return;
+        std::vector<PendingPut> batch;
+        batch.swap(pending_);
+        lock.unlock();
+
+        std::string buffer;
+        for (const auto& put : batch) {
+            std::string payload;
+            append_int<uint8_t>(payload, OP_PUT);
+            append_int<uint64_t>(payload, put.seq);
+            append_int<uint16_t>(payload, static_cast<uint16_t>(put.file_id.size()));
+            payload += put.file_id;
+            encode_meta(payload, put.meta);
+            append_record(buffer, payload);
+        }
+
+        uint64_t last = batch.back().seq;
+        bool ok = true;
+        try {
+            write_all(wal_fd_, buffer);
+            sync_file(wal_fd_);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << ": metadata log disabled\n";
+            ok = false;
+        }
+        if (ok) {
+            wal_bytes_ += buffer.size();
+            commits_++;
+            records_ += batch.size();
+            apply(batch);
+        }
+
+        lock.lock();
+        if (ok) durable_seq_ = last;
+        else failed_ = true;
+        committed_.notify_all();
+
+        if (ok && wal_bytes_ >= options_.compact_bytes) {
+            lock.unlock();
+            try {
+                compact();
+            } catch (const std::exception& e) {
+                std::cerr << "Metadata compaction failed: " << e.what() << "\n";
+            }
+            lock.lock();
+        }
+    }
+}
+
+void MetadataStore::remember(const std::string& file_id, FileMetadata meta) {
+    bool is_new = recent_.insert_or_assign(file_id, std::move(meta));
+    if (is_new && !snapshot_.load()->lookup(file_id)) files_++;
+}
+
+void MetadataStore::apply(std::vector<PendingPut>& batch) {
+    for (auto& put : batch) {
+        remember(put.file_id, std::move(put.meta));
+        applied_seq_ = put.seq;
+    }
+}
+
+// Une el snapshot actual con los registros recientes en un snapshot nuevo y vacía el log.
+// Solo corre en el hilo del log, que es el único que modifica el índice, así que las
+// lecturas siguen usando el snapshot anterior hasta que se publica el nuevo.
+void MetadataStore::compact() {
+    std::shared_ptr<const Snapshot> old = snapshot_.load();
+
+    std::vector<std::pair<std::string_view, const FileMetadata*>> recent;
+    recent_.for_each([&](const std::string& file_id, const FileMetadata& meta) {
+        recent.emplace_back(file_id, &meta);
+    });
+    std::sort(recent.begin(), recent.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<SnapshotEntry> entries;
+    std::deque<std::string> encoded;
+    entries.reserve(old->count + recent.size());
+    size_t i = 0;
+    auto it = recent.begin();
+    while (i < old->count || it != recent.end()) {
+        SnapshotEntry previous;
+        if (i < old->count) previous = old->entry(i);
+        if (it == recent.end() || (i < old->count && previous.key < it->first)) {
+            entries.push_back(previous);
+            i++;
+            continue;
+        }
+        if (i < old->count && previous.key == it->first) i++;
+        encode_meta(encoded.emplace_back(), *it->second);
+        entries.push_back({it->first, encoded.back()});
+        ++it;
+    }
+
+    std::string out;
+    out.append(SNAPSHOT_MAGIC, 8);
+    append_int<uint32_t>(out, SNAPSHOT_VERSION);
+    append_int<uint32_t>(out, 0);
+    append_int<uint64_t>(out, entries.size());
+    append_int<uint64_t>(out, applied_seq_);
+    uint64_t offset = SNAPSHOT_HEADER + entries.size() * SNAPSHOT_ENTRY;
+    for (const auto& entry : entries) {
+        append_int<uint64_t>(out, offset);
+        append_int<uint64_t>(out, offset + entry.key.size());
+        append_int<uint32_t>(out, static_cast<uint32_t>(entry.key.size()));
+        append_int<uint32_t>(out, static_cast<uint32_t>(entry.value.size()));
+        offset += entry.key.size() + entry.value.size();
+    }
+    for (const auto& entry : entries) {
+        out += entry.key;
+        out += entry.value;
+    }
+
+    std::string path = (fs::path(options_.dir) / snapshot_name(applied_seq_)).string();
+    replace_file(path, out);
+
+    // Publica el snapshot nuevo antes de olvidar los registros que ya contiene
+    snapshot_ = std::make_shared<const Snapshot>(path);
+    recent_.clear();
+    if (!old->path.empty()) {
+        // Las lecturas en curso pueden seguir usando la proyección anterior
+        std::error_code ignored;
+        fs::remove(old->path, ignored);
+    }
+
+    // Si el proceso cae antes de vaciar el log, sus registros ya están en el snapshot y se ignoran
+    truncate_file(wal_fd_);
+    sync_file(wal_fd_);
+    wal_bytes_ = 0;
+    compactions_++;
+}
+
+std::optional<FileMetadata> MetadataStore::get(const std::string& file_id) const {
+    if (auto meta = recent_.find(file_id)) return meta;
+    return snapshot_.load()->find(file_id);
+}
+
+std::vector<std::string> MetadataStore::file_ids() const {
+    // recent_ antes que el snapshot: una compactación publica el snapshot nuevo antes de
+    // vaciar recent_, así que ningún registro se pierde entre las dos lecturas
+    std::vector<std::string> ids;
+    recent_.for_each([&](const std::string& file_id, const FileMetadata&) { ids.push_back(file_id); });
+    std::shared_ptr<const Snapshot> snapshot = snapshot_.load();
+    for (size_t i = 0; i < snapshot->count; i++) ids.emplace_back(snapshot->entry(i).key);
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+MetadataStore::Stats MetadataStore::stats() const {
+    Stats stats;
+    stats.files = files_;
+    stats.wal_bytes = wal_bytes_;
+    stats.commits = commits_;
+    stats.records = records_;
+    stats.compactions = compactions_;
+    return stats;
+}
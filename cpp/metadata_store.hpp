@@ -0,0 +1,124 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sharded_map.hpp"
+#include "stripe.hpp"
+
+// Rango de bytes de un archivo guardado en las franjas de un contenedor (el archivo
+// cuya subida escribió esos chunks por primera vez, que puede ser él mismo)
+struct Extent {
+    std::string container;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+// Lo que el controlador necesita saber de un archivo para reconstruirlo
+struct FileMetadata {
+    StripeLayout layout;           // franjas guardadas por este archivo
+    std::string codec = "xor";
+    std::vector<uint32_t> checksums; // CRC32C de cada unidad, k + m por franja; vacío si no se calcularon
+    std::vector<uint32_t> stripe_checksums; // CRC32C de los datos de cada franja (sin comprimir)
+    std::vector<Extent> extents;   // contenido deduplicado; vacío si el archivo son sus franjas
+    bool updatable = false;        // subido sin deduplicar ni comprimir: admite escrituras en sitio
+
+    // Tamaño del archivo tal como se subió
+    uint64_t size() const {
+        if (extents.empty()) return layout.file_size;
+        uint64_t total = 0;
+        for (const auto& extent : extents) total += extent.length;
+        return total;
+    }
+};
+
+// Índice persistente file_id -> FileMetadata en options.dir:
+// - wal.log: cada put() se agrega al log y espera su fsync; los put() que llegan mientras
+//   se sincroniza un lote se escriben juntos con un solo fsync (group commit).
+// - snapshot-<seq>.bin: cuando el log supera compact_bytes se escribe un snapshot ordenado por
+//   file_id y se vacía el log. Al arrancar el snapshot se proyecta en memoria y se consulta
+//   con búsqueda binaria; solo se reproduce lo que quedó en el log.
+// Las consultas nunca toman un candado exclusivo ni esperan a un fsync: copian el puntero al
+// snapshot publicado y leen una parte del mapa de registros recientes.
+class MetadataStore {
+public:
+    struct Options {
+        std::string dir = "storage/controller";
+        size_t compact_bytes = 4 * 1024 * 1024;
+    };
+
+    struct Stats {
+        size_t files = 0;
+        uint64_t wal_bytes = 0;
+        uint64_t commits = 0;     // fsyncs del log
+        uint64_t records = 0;     // registros escritos en esos fsyncs
+        uint64_t compactions = 0;
+    };
+
+    explicit MetadataStore(Options options);
+    ~MetadataStore();
+
+    MetadataStore(const MetadataStore&) = delete;
+    MetadataStore& operator=(const MetadataStore&) = delete;
+
+    // Vuelve cuando el registro ya está en disco; lanza std::runtime_error si no se pudo escribir
+    void put(const std::string& file_id, const FileMetadata& meta);
+
+    std::optional<FileMetadata> get(const std::string& file_id) const;
+
+    // Ids de todos los archivos guardados, ordenados (los que se agreguen mientras tanto
+    // pueden faltar)
+    std::vector<std::string> file_ids() const;
+
+    Stats stats() const;
+
+private:
+    struct PendingPut {
+        uint64_t seq;
+        std::string file_id;
+        FileMetadata meta;
+    };
+
+    struct Snapshot; // snapshot proyectado en memoria (metadata_store.cpp)
+
+    void load_snapshot();
+    void replay_wal();
+    void flush_loop();
+    void remember(const std::string& file_id, FileMetadata meta);
+    void apply(std::vector<PendingPut>& batch);
+    void compact();
+
+    Options options_;
+    std::string wal_path_;
+
+    // Índice: snapshot publicado + registros posteriores. Solo el hilo del log los modifica;
+    // un snapshot nuevo se publica antes de vaciar recent_, así que una lectura siempre
+    // encuentra el registro en uno de los dos.
+    std::atomic<std::shared_ptr<const Snapshot>> snapshot_;
+    ShardedMap<std::string, FileMetadata> recent_;
+    uint64_t applied_seq_ = 0;
+    std::atomic<size_t> files_{0};
+
+    // Log: put() encola y espera; flush_loop() escribe los lotes
+    std::mutex log_mutex_;
+    std::condition_variable log_ready_;
+    std::condition_variable committed_;
+    std::vector<PendingPut> pending_;
+    uint64_t next_seq_ = 0;
+    uint64_t durable_seq_ = 0;
+    bool failed_ = false;
+    bool stop_ = false;
+    int wal_fd_ = -1;
+    std::atomic<uint64_t> wal_bytes_{0};
+
+    std::atomic<uint64_t> commits_{0};
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> compactions_{0};
+
+    std::thread flusher_;
+};
@@ -0,0 +1,98 @@
+#include "node_client.hpp"
+#include "json.hpp"
+#include <charconv>
+#include <iostream>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+Transport parse_transport(const std::string& name) {
+    if (name == "binary") return Transport::Binary;
+    if (name == "json") return Transport::Json;
+    throw std::runtime_error("Unknown transport: " + name);
+}
+
+BlockStatus store_block(httplib::Client& client, const std::string& block_id,
+                        const uint8_t* data, size_t len, Transport transport) {
+    httplib::Result res;
+    if (transport == Transport::Binary) {
+        httplib::Headers headers = {
+            {"X-Block-Id", block_id},
+            {"X-Block-Length", std::to_string(len)}
+        };
+        res = client.Post("/store", headers, reinterpret_cast<const char*>(data), len,
+                          "application/octet-stream");
+    } else {
+        json block_json;
+        block_json["id"] = block_id;
+        block_json["data"] = ByteBlock(data, data + len);
+        res = client.Post("/store", block_json.dump(), "application/json");
+    }
+
+    if (!res) {
+        std::cerr << "Connection failed storing " << block_id << "\n";
+        return BlockStatus::Unreachable;
+    }
+    if (res->status != 200) {
+        std::cerr << "Error storing " << block_id << ": " << res->status << " - " << res->body << "\n";
+        return BlockStatus::Error;
+    }
+    return BlockStatus::Ok;
+}
+
+BlockStatus fetch_block(httplib::Client& client, const std::string& block_id,
+                        ByteBlock& out, Transport transport) {
+    httplib::Headers headers;
+    if (transport == Transport::Binary) headers.emplace("Accept", "application/octet-stream");
+    auto res = client.Get("/retrieve/" + block_id, headers);
+    if (!res) {
+        std::cerr << "Failed to get " << block_id << ": " << httplib::to_string(res.error()) << "\n";
+        return BlockStatus::Unreachable;
+    }
+    if (res->status != 200) {
+        std::cerr << "Failed to get " << block_id << ": " << res->status << "\n";
+        return BlockStatus::Error;
+    }
+
+    // Un nodo antiguo puede responder en JSON aunque se pida binario
+    if (res->get_header_value("Content-Type").find("application/octet-stream") != std::string::npos) {
+        std::string length = res->get_header_value("X-Block-Length");
+        if (!length.empty()) {
+            // Un encabezado inválido es una respuesta mala del nodo, no una excepción
+            uint64_t expected = 0;
+            auto [end, ec] = std::from_chars(length.data(), length.data() + length.size(), expected);
+            if (ec != std::errc() || end != length.data() + length.size()) {
+                std::cerr << "Invalid X-Block-Length for " << block_id << ": '" << length << "'\n";
+                return BlockStatus::Error;
+            }
+            if (expected != res->body.size()) {
+                std::cerr << "Truncated block " << block_id << ": expected " << length
+                          << " bytes, got " << res->body.size() << "\n";
+                return BlockStatus::Error;
+            }
+        }
+        out.assign(res->body.begin(), res->body.end());
+        return BlockStatus::Ok;
+    }
+    try {
+        auto json_data = json::parse(res->body);
+        out = json_data["data"].get<ByteBlock>();
+        return BlockStatus::Ok;
+    } catch (const json::exception& e) {
+        std::cerr << "JSON error for " << block_id << ": " << e.what() << "\n";
+        return BlockStatus::Error;
+    }
+}
+
+BlockStatus delete_block(httplib::Client& client, const std::string& block_id) {
+    auto res = client.Delete("/block/" + block_id);
+    if (!res) {
+        std::cerr << "Failed to delete " << block_id << ": " << httplib::to_string(res.error()) << "\n";
+        return BlockStatus::Unreachable;
+    }
+    if (res->status != 200 && res->status != 404) {
+        std::cerr << "Failed to delete " << block_id << ": " << res->status << "\n";
+        return BlockStatus::Error;
+    }
+    return BlockStatus::Ok;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "httplib.h"
+
+using ByteBlock = std::vector<uint8_t>; // Array de longitud variable con datos binarios
+
+// Formato de los bloques entre el controlador y los Disk Nodes
+enum class Transport {
+    Binary, // application/octet-stream, id y longitud en X-Block-Id / X-Block-Length
+    Json    // {"id": ..., "data": [enteros]} (formato original, por compatibilidad)
+};
+
+Transport parse_transport(const std::string& name);
+
+// Resultado de una operación sobre un bloque
+enum class BlockStatus {
+    Ok,
+    Error,       // el nodo respondió con error (p.ej. bloque inexistente o respuesta inválida)
+    Unreachable  // sin respuesta: la conexión no sirve y no debe reutilizarse
+};
+
+// Guarda un bloque en el nodo (registra el error si no se pudo)
+BlockStatus store_block(httplib::Client& client, const std::string& block_id,
+                        const uint8_t* data, size_t len, Transport transport);
+
+// Descarga un bloque en out
+BlockStatus fetch_block(httplib::Client& client, const std::string& block_id,
+                        ByteBlock& out, Transport transport);
+
+// Borra un bloque del nodo; un bloque que no existe cuenta como borrado
+BlockStatus delete_block(httplib::Client& client, const std::string& block_id);
@@ -0,0 +1,46 @@
+#include "node_health.hpp"
+
+const char* node_state_name(NodeState state) {
+    switch (state) {
+        case NodeState::Up: return "up";
+        case NodeState::Suspect: return "suspect";
+        case NodeState::Down: return "down";
+    }
+    return "unknown";
+}
+
+NodeState NodeHealth::record(size_t node, bool ok, double ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (node >= nodes_.size()) nodes_.resize(node + 1);
+    Entry& entry = nodes_[node];
+    NodeState before = entry.stats.state;
+    entry.stats.probes++;
+    if (ok) {
+        entry.stats.last_ms = ms;
+        entry.failed_in_row = 0;
+        entry.ok_in_row++;
+        if (before == NodeState::Suspect || (before == NodeState::Down && entry.ok_in_row >= options_.up_after)) {
+            entry.stats.state = NodeState::Up;
+        }
+    } else {
+        entry.stats.failures++;
+        entry.ok_in_row = 0;
+        entry.failed_in_row++;
+        if (entry.failed_in_row >= options_.down_after) entry.stats.state = NodeState::Down;
+        else if (before == NodeState::Up) entry.stats.state = NodeState::Suspect;
+    }
+    if (entry.stats.state != before) entry.stats.transitions++;
+    return before;
+}
+
+NodeState NodeHealth::state(size_t node) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return node < nodes_.size() ? nodes_[node].stats.state : NodeState::Up;
+}
+
+std::vector<NodeHealth::NodeStats> NodeHealth::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<NodeStats> out;
+    for (const auto& entry : nodes_) out.push_back(entry.stats);
+    return out;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Estado de un Disk Node según los últimos sondeos (heartbeats)
+enum class NodeState : uint8_t {
+    Up,      // responde
+    Suspect, // falló el último sondeo: se sigue usando, pero después de los demás
+    Down     // falló down_after sondeos seguidos: las peticiones no lo contactan
+};
+
+const char* node_state_name(NodeState state);
+
+// Máquina de estados de salud de cada nodo, con histéresis para que un nodo que responde a
+// veces no cambie de estado en cada sondeo: Up pasa a Suspect con un fallo y a Down con
+// down_after fallos seguidos; Suspect vuelve a Up con un sondeo correcto, pero Down necesita
+// up_after sondeos correctos seguidos. Los nodos sin sondeos todavía cuentan como Up.
+class NodeHealth {
+public:
+    struct Options {
+        size_t down_after = 3;
+        size_t up_after = 2;
+    };
+
+    struct NodeStats {
+        NodeState state = NodeState::Up;
+        uint64_t probes = 0;
+        uint64_t failures = 0;     // sondeos fallidos en total
+        uint64_t transitions = 0;  // cambios de estado
+        double last_ms = 0;        // duración del último sondeo correcto
+    };
+
+    explicit NodeHealth(Options options) : options_(options) {}
+
+    // Registra un sondeo del nodo y devuelve el estado que tenía antes
+    NodeState record(size_t node, bool ok, double ms);
+
+    NodeState state(size_t node) const;
+    bool is_down(size_t node) const { return state(node) == NodeState::Down; }
+
+    std::vector<NodeStats> stats() const;
+
+private:
+    struct Entry {
+        NodeStats stats;
+        size_t failed_in_row = 0;
+        size_t ok_in_row = 0;
+    };
+
+    Options options_;
+    mutable std::mutex mutex_;
+    std::vector<Entry> nodes_; // crece al sondear un nodo registrado después
+};
@@ -0,0 +1,83 @@
+#include "node_ring.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Mezcla final de splitmix64
+uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+// FNV-1a de 64 bits: a diferencia de std::hash da lo mismo en cualquier compilador y versión,
+// así los puntos del anillo no cambian entre reinicios
+uint64_t hash_text(const std::string& text) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (unsigned char c : text) {
+        h ^= c;
+        h *= 0x100000001b3ull;
+    }
+    return mix(h);
+}
+
+} // namespace
+
+NodeRing::NodeRing(const std::vector<std::string>& nodes, const std::vector<double>& weights, size_t width)
+    : width_(width), node_count_(nodes.size()) {
+    if (weights.size() != nodes.size()) throw std::runtime_error("Ring needs one weight per node");
+    if (nodes.size() > UINT16_MAX) throw std::runtime_error("Ring supports at most 65535 nodes");
+    size_t weighted = 0;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (weights[i] < 0) throw std::runtime_error("Node weights must not be negative");
+        if (weights[i] == 0) continue;
+        weighted++;
+        size_t count = std::max<size_t>(1, std::lround(weights[i] * POINTS_PER_WEIGHT));
+        for (size_t p = 0; p < count; p++) {
+            points_.push_back({hash_text(nodes[i] + "#" + std::to_string(p)), static_cast<uint16_t>(i)});
+        }
+    }
+    if (width == 0 || weighted < width) {
+        throw std::runtime_error("Ring needs at least " + std::to_string(width) + " nodes with positive weight");
+    }
+    std::sort(points_.begin(), points_.end(), [](const Point& a, const Point& b) { return a.hash < b.hash; });
+
+    // Nodos distintos a partir de cada punto; con pocos nodos la vuelta puede ser larga, por eso
+    // se hace una sola vez acá y no en cada franja
+    size_t n = points_.size();
+    successors_.resize(n * width);
+    std::vector<size_t> seen(nodes.size(), n);
+    for (size_t p = 0; p < n; p++) {
+        size_t found = 0;
+        for (size_t j = p; found < width; j = j + 1 == n ? 0 : j + 1) {
+            uint16_t node = points_[j].node;
+            if (seen[node] == p) continue;
+            seen[node] = p;
+            successors_[p * width + found++] = node;
+        }
+    }
+
+    // 2^b cubetas, con 2^b >= puntos: en promedio menos de un punto por cubeta
+    unsigned bits = 1;
+    while ((size_t{1} << bits) < n) bits++;
+    shift_ = 64 - bits;
+    buckets_.resize(size_t{1} << bits);
+    size_t p = 0;
+    for (size_t b = 0; b < buckets_.size(); b++) {
+        while (p < n && points_[p].hash < (uint64_t{b} << shift_)) p++;
+        buckets_[b] = static_cast<uint32_t>(p);
+    }
+}
+
+void NodeRing::place(const std::string& file_id, uint64_t stripe, uint16_t* out) const {
+    uint64_t h = mix(hash_text(file_id) ^ mix(stripe + 1));
+    size_t p = buckets_[h >> shift_];
+    while (p < points_.size() && points_[p].hash < h) p++;
+    if (p == points_.size()) p = 0; // pasado el último punto se vuelve al primero
+    std::copy_n(successors_.begin() + p * width_, width_, out);
+}
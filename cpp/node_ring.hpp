@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Anillo de hashing consistente que elige los k + m nodos de cada franja entre todos los de
+// la configuración. Cada nodo pone en el anillo una cantidad de puntos proporcional a su peso
+// (peso 0: no recibe franjas nuevas) y una franja va a los primeros width nodos distintos que
+// aparecen desde el hash de (archivo, franja) en sentido horario. Al agregar un nodo solo cambian
+// las franjas cuyos puntos caen en los tramos que toma el nuevo, alrededor de 1/N de los datos.
+// Los puntos se calculan con el nombre (URL) del nodo, no con su posición en la lista.
+// Es inmutable: se consulta desde cualquier hilo sin candados. Para que place() sea O(width)
+// se precalculan los width nodos distintos que siguen a cada punto, y un índice por los bits
+// altos del hash lleva al punto sin búsqueda binaria.
+class NodeRing {
+public:
+    static constexpr size_t POINTS_PER_WEIGHT = 128; // puntos de un nodo con peso 1
+
+    // nodes y weights en el orden de la configuración; lanza si no hay width nodos con peso
+    NodeRing(const std::vector<std::string>& nodes, const std::vector<double>& weights, size_t width);
+
+    // Escribe en out los width nodos (índices en nodes, distintos) de la franja, en orden:
+    // out[i] guarda la unidad i (datos primero y paridad al final). Con otro anillo el orden
+    // puede correrse; lo que se conserva es el conjunto, así que al mudar una franja solo
+    // cambian de nodo las unidades de los nodos que quedaron fuera.
+    void place(const std::string& file_id, uint64_t stripe, uint16_t* out) const;
+
+    size_t width() const { return width_; }
+    size_t node_count() const { return node_count_; }
+    size_t point_count() const { return points_.size(); }
+
+private:
+    struct Point {
+        uint64_t hash;
+        uint16_t node;
+    };
+
+    size_t width_;
+    size_t node_count_;
+    std::vector<Point> points_;       // ordenados por hash
+    std::vector<uint16_t> successors_; // width nodos por punto
+    std::vector<uint32_t> buckets_;   // primer punto con hash >= bucket << shift_
+    unsigned shift_ = 64;
+};
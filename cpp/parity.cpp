@@ -0,0 +1,167 @@
+#include "parity.hpp"
+#include "cpu_features.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+using XorFn = void (*)(uint8_t*, const uint8_t* const*, size_t, size_t);
+
+void xor_blocks_scalar(uint8_t* dst, const uint8_t* const* srcs, size_t count, size_t len) {
+    size_t i = 0;
+    // 8 bytes por iteración; memcpy evita accesos desalineados
+    for (; i + 8 <= len; i += 8) {
+        uint64_t acc;
+        std::memcpy(&acc, srcs[0] + i, 8);
+        for (size_t s = 1; s < count; s++) {
+            uint64_t v;
+            std::memcpy(&v, srcs[s] + i, 8);
+            acc ^= v;
+        }
+        std::memcpy(dst + i, &acc, 8);
+    }
+    for (; i < len; i++) {
+        uint8_t acc = srcs[0][i];
+        for (size_t s = 1; s < count; s++) acc ^= srcs[s][i];
+        dst[i] = acc;
+    }
+}
+
+#if defined(PROYECTO_X86)
+PROYECTO_TARGET("sse2")
+void xor_blocks_sse2(uint8_t* dst, const uint8_t* const* srcs, size_t count, size_t len) {
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) { // 4 registros por iteración
+        const uint8_t* p = srcs[0] + i;
+        __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+        __m128i a2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32));
+        __m128i a3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48));
+        for (size_t s = 1; s < count; s++) {
+            p = srcs[s] + i;
+            a0 = _mm_xor_si128(a0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+            a1 = _mm_xor_si128(a1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16)));
+            a2 = _mm_xor_si128(a2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32)));
+            a3 = _mm_xor_si128(a3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), a0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16), a1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 32), a2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 48), a3);
+    }
+    if (i < len) {
+        const uint8_t* tail[64];
+        for (size_t s = 0; s < count && s < 64; s++) tail[s] = srcs[s] + i;
+        xor_blocks_scalar(dst + i, tail, count, len - i);
+    }
+}
+
+PROYECTO_TARGET("avx2")
+void xor_blocks_avx2(uint8_t* dst, const uint8_t* const* srcs, size_t count, size_t len) {
+    size_t i = 0;
+    for (; i + 128 <= len; i += 128) {
+        const uint8_t* p = srcs[0] + i;
+        __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+        __m256i a2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 64));
+        __m256i a3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 96));
+        for (size_t s = 1; s < count; s++) {
+            p = srcs[s] + i;
+            a0 = _mm256_xor_si256(a0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+            a1 = _mm256_xor_si256(a1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)));
+            a2 = _mm256_xor_si256(a2, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 64)));
+            a3 = _mm256_xor_si256(a3, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 96)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), a0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 32), a1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 64), a2);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 96), a3);
+    }
+    if (i < len) {
+        const uint8_t* tail[64];
+        for (size_t s = 0; s < count && s < 64; s++) tail[s] = srcs[s] + i;
+        xor_blocks_sse2(dst + i, tail, count, len - i);
+    }
+}
+
+PROYECTO_TARGET("avx512f")
+void xor_blocks_avx512(uint8_t* dst, const uint8_t* const* srcs, size_t count, size_t len) {
+    size_t i = 0;
+    for (; i + 256 <= len; i += 256) {
+        const uint8_t* p = srcs[0] + i;
+        __m512i a0 = _mm512_loadu_si512(p);
+        __m512i a1 = _mm512_loadu_si512(p + 64);
+        __m512i a2 = _mm512_loadu_si512(p + 128);
+        __m512i a3 = _mm512_loadu_si512(p + 192);
+        for (size_t s = 1; s < count; s++) {
+            p = srcs[s] + i;
+            a0 = _mm512_xor_si512(a0, _mm512_loadu_si512(p));
+            a1 = _mm512_xor_si512(a1, _mm512_loadu_si512(p + 64));
+            a2 = _mm512_xor_si512(a2, _mm512_loadu_si512(p + 128));
+            a3 = _mm512_xor_si512(a3, _mm512_loadu_si512(p + 192));
+        }
+        _mm512_storeu_si512(dst + i, a0);
+        _mm512_storeu_si512(dst + i + 64, a1);
+        _mm512_storeu_si512(dst + i + 128, a2);
+        _mm512_storeu_si512(dst + i + 192, a3);
+    }
+    if (i < len) {
+        const uint8_t* tail[64];
+        for (size_t s = 0; s < count && s < 64; s++) tail[s] = srcs[s] + i;
+        xor_blocks_avx2(dst + i, tail, count, len - i);
+    }
+}
+#endif
+
+struct XorKernel {
+    const char* name;
+    XorFn fn;
+};
+
+// Elige el kernel más ancho disponible (o el forzado con PROYECTO_SIMD)
+XorKernel select_kernel() {
+    const CpuFeatures& cpu = cpu_features();
+#if defined(PROYECTO_X86)
+    if (simd_tier_allowed("avx512") && cpu.avx512f && cpu.avx2) return {"avx512", xor_blocks_avx512};
+    if (simd_tier_allowed("avx2") && cpu.avx2) return {"avx2", xor_blocks_avx2};
+    if (simd_tier_allowed("sse2") && cpu.sse2) return {"sse2", xor_blocks_sse2};
+#endif
+    (void)cpu;
+    return {"scalar", xor_blocks_scalar};
+}
+
+const XorKernel& kernel() {
+    static const XorKernel selected = select_kernel();
+    return selected;
+}
+
+} // namespace
+
+void xor_blocks(uint8_t* dst, const uint8_t* const* srcs, size_t count, size_t len) {
+    if (count == 0) {
+        std::memset(dst, 0, len);
+        return;
+    }
+    // las colas de los kernels SIMD usan un arreglo fijo de 64 punteros
+    if (count > 64) {
+        kernel().fn(dst, srcs, 64, len);
+        for (size_t s = 64; s < count; s += 63) {
+            const uint8_t* rest[64];
+            rest[0] = dst;
+            size_t n = std::min<size_t>(63, count - s);
+            for (size_t j = 0; j < n; j++) rest[j + 1] = srcs[s + j];
+            kernel().fn(dst, rest, n + 1, len);
+        }
+        return;
+    }
+    kernel().fn(dst, srcs, count, len);
+}
+
+void xor_into(uint8_t* dst, const uint8_t* src, size_t len) {
+    const uint8_t* srcs[2] = {dst, src};
+    kernel().fn(dst, srcs, 2, len);
+}
+
+const char* parity_kernel_name() {
+    return kernel().name;
+}
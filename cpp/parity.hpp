@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// dst = srcs[0] ^ srcs[1] ^ ... ^ srcs[count-1], en una sola pasada sobre dst.
+// dst puede ser igual a srcs[0] (acumulación en sitio).
+void xor_blocks(uint8_t* dst, const uint8_t* const* srcs, size_t count, size_t len);
+
+// dst ^= src
+void xor_into(uint8_t* dst, const uint8_t* src, size_t len);
+
+// Nombre del kernel elegido al arrancar: "avx512", "avx2", "sse2" o "scalar"
+const char* parity_kernel_name();
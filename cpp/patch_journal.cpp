@@ -0,0 +1,134 @@
+#include "patch_journal.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include "durable_file.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Formato en disco (ver durable_file.hpp):
+//   patch.journal: registros [u8 op][u64 seq] seguidos de
+//     OP_BEGIN: [u16 largo][id][u64 franja][u32 crc franja][u32 unidades]
+//               y por unidad [u32 índice][u32 crc][u64 largo][contenido]
+//     OP_END:   nada
+constexpr uint8_t OP_BEGIN = 1;
+constexpr uint8_t OP_END = 2;
+
+std::string encode_begin(uint64_t seq, const StripePatch& patch) {
+    std::string payload;
+    append_int<uint8_t>(payload, OP_BEGIN);
+    append_int<uint64_t>(payload, seq);
+    append_int<uint16_t>(payload, static_cast<uint16_t>(patch.file_id.size()));
+    payload += patch.file_id;
+    append_int<uint64_t>(payload, patch.stripe);
+    append_int<uint32_t>(payload, patch.stripe_checksum);
+    append_int<uint32_t>(payload, static_cast<uint32_t>(patch.units.size()));
+    for (size_t u = 0; u < patch.units.size(); u++) {
+        append_int<uint32_t>(payload, patch.units[u]);
+        append_int<uint32_t>(payload, patch.checksums[u]);
+        append_int<uint64_t>(payload, patch.contents[u].size());
+        payload.append(reinterpret_cast<const char*>(patch.contents[u].data()), patch.contents[u].size());
+    }
+    std::string record;
+    append_record(record, payload);
+    return record;
+}
+
+StripePatch decode_begin(RecordReader& in) {
+    StripePatch patch;
+    patch.file_id = in.read_string(in.read<uint16_t>());
+    patch.stripe = in.read<uint64_t>();
+    patch.stripe_checksum = in.read<uint32_t>();
+    uint32_t count = in.read<uint32_t>();
+    for (uint32_t u = 0; u < count; u++) {
+        patch.units.push_back(in.read<uint32_t>());
+        patch.checksums.push_back(in.read<uint32_t>());
+        std::string content = in.read_string(in.read<uint64_t>());
+        patch.contents.emplace_back(content.begin(), content.end());
+    }
+    return patch;
+}
+
+} // namespace
+
+PatchJournal::PatchJournal(const std::string& dir, size_t compact_bytes)
+    : path_((fs::path(dir) / "patch.journal").string()), compact_bytes_(compact_bytes) {
+    fs::create_directories(dir);
+    std::string log = read_file(path_);
+    size_t valid = read_records(log, [&](RecordReader& record) {
+        uint8_t op = record.read<uint8_t>();
+        uint64_t seq = record.read<uint64_t>();
+        next_seq_ = std::max(next_seq_, seq);
+        if (op == OP_BEGIN) pending_[seq] = decode_begin(record);
+        else if (op == OP_END) pending_.erase(seq);
+        else return false;
+        return true;
+    });
+    if (valid < log.size()) {
+        std::cerr << "Discarding " << log.size() - valid << " bytes of incomplete patch journal\n";
+        fs::resize_file(path_, valid);
+    }
+    bytes_ = valid;
+    fd_ = open_file(path_, true);
+}
+
+PatchJournal::~PatchJournal() {
+    close_file(fd_);
+}
+
+uint64_t PatchJournal::begin(const StripePatch& patch) {
+    if (patch.file_id.size() > UINT16_MAX) throw std::runtime_error("File id too long");
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t seq = ++next_seq_;
+    std::string record = encode_begin(seq, patch);
+    write_all(fd_, record);
+    sync_file(fd_);
+    bytes_ += record.size();
+    pending_[seq] = patch;
+    return seq;
+}
+
+void PatchJournal::end(uint64_t seq) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.erase(seq);
+    std::string payload;
+    append_int<uint8_t>(payload, OP_END);
+    append_int<uint64_t>(payload, seq);
+    std::string record;
+    append_record(record, payload);
+    write_all(fd_, record);
+    bytes_ += record.size();
+    if (bytes_ - compacted_bytes_ < compact_bytes_) return;
+
+    // Reescribe el journal solo con las franjas pendientes
+    std::string log;
+    for (const auto& [pending_seq, patch] : pending_) log += encode_begin(pending_seq, patch);
+    close_file(fd_);
+    try {
+        replace_file(path_, log);
+        bytes_ = log.size();
+    } catch (const std::exception& e) {
+        std::cerr << "Patch journal not compacted: " << e.what() << "\n";
+    }
+    compacted_bytes_ = bytes_;
+    fd_ = open_file(path_, true);
+}
+
+std::vector<PatchJournal::Pending> PatchJournal::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Pending> result;
+    for (const auto& [seq, patch] : pending_) result.push_back({seq, patch});
+    return result;
+}
+
+std::vector<PatchJournal::Pending> PatchJournal::pending(const std::string& file_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Pending> result;
+    for (const auto& [seq, patch] : pending_) {
+        if (patch.file_id == file_id) result.push_back({seq, patch});
+    }
+    return result;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Contenido nuevo de las unidades de una franja que cambia una escritura en sitio
+struct StripePatch {
+    std::string file_id;
+    uint64_t stripe = 0;
+    std::vector<uint32_t> units;                 // índices 0..k+m-1 que se reescriben
+    std::vector<std::vector<uint8_t>> contents;  // contenido nuevo de cada una
+    std::vector<uint32_t> checksums;             // CRC32C de cada contenido nuevo
+    uint32_t stripe_checksum = 0;                // CRC32C nuevo de los datos de la franja
+};
+
+// Journal de intención (redo log) de las escrituras en sitio, en <dir>/patch.journal.
+// begin() deja la franja nueva en disco antes de tocar los nodos y end() la marca aplicada
+// cuando los metadatos ya tienen sus CRC32C. Una franja a medio escribir mezcla datos nuevos
+// con paridad vieja y podría no decodificarse; las que no se marcaron se vuelven a escribir
+// completas desde el journal (reescribirlas es idempotente).
+// end() no hace fsync: el fsync del begin() siguiente lo vuelve durable, y las escrituras de
+// un mismo archivo van en orden, así que nunca se reaplica una franja vieja sobre una nueva.
+class PatchJournal {
+public:
+    struct Pending {
+        uint64_t seq = 0;
+        StripePatch patch;
+    };
+
+    explicit PatchJournal(const std::string& dir, size_t compact_bytes = 64 * 1024 * 1024);
+    ~PatchJournal();
+
+    PatchJournal(const PatchJournal&) = delete;
+    PatchJournal& operator=(const PatchJournal&) = delete;
+
+    // Vuelve cuando el registro ya está en disco; lanza std::runtime_error si no se pudo escribir
+    uint64_t begin(const StripePatch& patch);
+
+    // Marca aplicada la franja; cuando el journal creció compact_bytes desde la última
+    // compactación se reescribe solo con las franjas pendientes (una que nunca se aplica no
+    // hace que se reescriba en cada end())
+    void end(uint64_t seq);
+
+    // Franjas sin marcar (de una ejecución anterior o cuyos nodos no respondieron), en orden
+    std::vector<Pending> pending() const;
+    std::vector<Pending> pending(const std::string& file_id) const;
+
+private:
+    std::string path_;
+    size_t compact_bytes_;
+    mutable std::mutex mutex_;
+    int fd_ = -1;
+    uint64_t next_seq_ = 0;
+    uint64_t bytes_ = 0;
+    uint64_t compacted_bytes_ = 0; // tamaño que dejó la última compactación
+    std::map<uint64_t, StripePatch> pending_;
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// Limita el tráfico de las tareas de fondo a bytes_per_second (0: sin límite). Cada acquire()
+// reserva su turno y espera hasta él, así varios hilos comparten el mismo límite.
+class RateLimiter {
+public:
+    explicit RateLimiter(double bytes_per_second) : rate_(bytes_per_second) {}
+
+    void acquire(size_t bytes) {
+        if (rate_ <= 0) return;
+        std::chrono::steady_clock::time_point at;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // Sin ráfagas: el tiempo que no se usó no se acumula
+            next_ = std::max(next_, std::chrono::steady_clock::now());
+            at = next_;
+            next_ += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(bytes / rate_));
+        }
+        std::this_thread::sleep_until(at);
+    }
+
+private:
+    double rate_;
+    std::mutex mutex_;
+    std::chrono::steady_clock::time_point next_{};
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include <array>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+
+// Mapa concurrente dividido en Shards partes, cada una con su propio shared_mutex.
+// Las lecturas solo toman el candado compartido de su parte, así que no compiten entre sí,
+// y una escritura solo detiene a las lecturas de las claves de su misma parte.
+template <class Key, class Value, size_t Shards = 64, class Hash = std::hash<Key>>
+class ShardedMap {
+public:
+    std::optional<Value> find(const Key& key) const {
+        const Shard& shard = shard_for(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) return std::nullopt;
+        return it->second;
+    }
+
+    bool contains(const Key& key) const {
+        const Shard& shard = shard_for(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.map.count(key) > 0;
+    }
+
+    // Inserta o reemplaza; devuelve true si la clave no existía
+    bool insert_or_assign(const Key& key, Value value) {
+        Shard& shard = shard_for(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.map.insert_or_assign(key, std::move(value)).second;
+    }
+
+    bool erase(const Key& key) {
+        Shard& shard = shard_for(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.map.erase(key) > 0;
+    }
+
+    // Recorre todas las entradas, una parte a la vez (no es una vista atómica del mapa)
+    template <class Fn>
+    void for_each(Fn fn) const {
+        for (const Shard& shard : shards_) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            for (const auto& [key, value] : shard.map) fn(key, value);
+        }
+    }
+
+    void clear() {
+        for (Shard& shard : shards_) {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            shard.map.clear();
+        }
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const Shard& shard : shards_) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            total += shard.map.size();
+        }
+        return total;
+    }
+
+private:
+    // Cada parte en su propia línea de caché para que los candados no se invaliden entre sí
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Key, Value, Hash> map;
+    };
+
+    Shard& shard_for(const Key& key) { return shards_[Hash{}(key) % Shards]; }
+    const Shard& shard_for(const Key& key) const { return shards_[Hash{}(key) % Shards]; }
+
+    std::array<Shard, Shards> shards_;
+};
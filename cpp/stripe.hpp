@@ -0,0 +1,95 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Cómo se guardaron los datos de una franja antes de codificarla
+enum class StripeCompression : uint8_t {
+    None = 0, // tal cual
+    Lz4 = 1,  // bloque LZ4 (compression.hpp)
+};
+
+// En qué nodo queda cada unidad de una franja
+enum class Placement : uint8_t {
+    Fixed = 0,    // la unidad i en el nodo i: la paridad siempre en los mismos nodos (formato original)
+    Rotating = 1, // RAID-5 left-symmetric: la paridad retrocede un nodo en cada franja
+    Hashed = 2,   // cada franja en k + m de los N nodos, elegidos con el anillo (node_ring.hpp)
+};
+
+struct StripeEncoding {
+    StripeCompression compression = StripeCompression::None;
+    uint64_t stored_length = 0; // bytes repartidos entre las k unidades (sin relleno)
+};
+
+// Distribución de un archivo en franjas (stripes) de k unidades de stripe_unit bytes.
+// Cada franja lleva sus propias m unidades de paridad; la última franja puede ser más corta
+// y sus unidades miden ceil(bytes restantes / k), así el relleno nunca supera k - 1 bytes.
+// Si la franja se comprimió, las unidades miden ceil(bytes comprimidos / k); los offsets del
+// archivo siguen contando bytes sin comprimir, así que cada franja cubre el mismo rango.
+// Con Fixed y Rotating las unidades de una franja van a los nodos 0..k+m-1 de la configuración;
+// con Hashed, a los nodos que el anillo eligió al escribirla, guardados en stripe_nodes.
+struct StripeLayout {
+    size_t file_size = 0;
+    size_t k = 3;
+    size_t m = 1;
+    size_t stripe_unit = 256 * 1024;
+    std::vector<StripeEncoding> encodings; // una por franja; vacío si ninguna se comprimió
+    Placement placement = Placement::Fixed;
+    std::vector<uint16_t> stripe_nodes; // con Hashed, k + m índices de nodo por franja
+
+    // Nodo que guarda la unidad i (0..k-1 datos, k..k+m-1 paridad) de la franja. Con rotación
+    // la franja s empieza desplazada s nodos hacia atrás: la paridad de la franja 0 queda en el
+    // último nodo, la de la 1 en el anterior, y los datos siguen a la paridad dando la vuelta.
+    size_t node(size_t stripe, size_t unit) const {
+        if (placement == Placement::Fixed) return unit;
+        size_t n = k + m;
+        if (placement == Placement::Hashed) return stripe_nodes[stripe * n + unit];
+        return (unit + n - stripe % n) % n;
+    }
+
+    // Unidad de la franja que guarda el nodo (inversa de node); k + m si el nodo no participa
+    size_t unit_on(size_t stripe, size_t node) const {
+        size_t n = k + m;
+        if (placement == Placement::Hashed) {
+            auto first = stripe_nodes.begin() + stripe * n;
+            return std::find(first, first + n, node) - first;
+        }
+        if (node >= n) return n;
+        if (placement == Placement::Fixed) return node;
+        return (node + stripe % n) % n;
+    }
+
+    // Bytes de datos que caben en una franja completa
+    size_t stripe_width() const { return k * stripe_unit; }
+
+    size_t stripe_count() const {
+        return file_size == 0 ? 0 : (file_size + stripe_width() - 1) / stripe_width();
+    }
+
+    size_t stripe_offset(size_t stripe) const { return stripe * stripe_width(); }
+
+    // Bytes reales (sin relleno) de la franja
+    size_t stripe_length(size_t stripe) const {
+        return std::min(stripe_width(), file_size - stripe_offset(stripe));
+    }
+
+    StripeEncoding encoding(size_t stripe) const {
+        if (stripe < encodings.size()) return encodings[stripe];
+        return {StripeCompression::None, stripe_length(stripe)};
+    }
+
+    // Bytes guardados de la franja (comprimidos o no), sin relleno
+    size_t stored_length(size_t stripe) const { return encoding(stripe).stored_length; }
+
+    // Tamaño de cada unidad (datos y paridad) de la franja
+    size_t unit_length(size_t stripe) const { return (stored_length(stripe) + k - 1) / k; }
+};
+
+// Identificador de la unidad i de una franja: 0..k-1 datos, k..k+m-1 paridad
+inline std::string unit_id(const std::string& file_id, size_t stripe, size_t i, size_t k) {
+    std::string prefix = file_id + "_s" + std::to_string(stripe);
+    if (i < k) return prefix + "_block" + std::to_string(i);
+    return prefix + "_parity" + std::to_string(i - k);
+}
@@ -0,0 +1,171 @@
+#include "stripe_cache.hpp"
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+// Mezcla final de splitmix64: distribuye bien hashes que solo difieren en pocos bits
+uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+size_t next_power_of_two(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// Bytes de una entrada: los datos más la clave y los nodos de la lista y del índice
+size_t entry_bytes(const std::string& file_id, size_t data_bytes) {
+    return data_bytes + file_id.size() + 128;
+}
+
+constexpr uint8_t MAX_COUNT = 15;
+
+} // namespace
+
+size_t StripeCache::KeyHash::operator()(const Key& key) const {
+    return mix(std::hash<std::string>{}(key.file_id) ^ mix(key.stripe));
+}
+
+StripeCache::FrequencySketch::FrequencySketch(size_t width, size_t sample)
+    : counters_(DEPTH * width, 0), mask_(width - 1), sample_(sample) {}
+
+size_t StripeCache::FrequencySketch::index(uint64_t hash, size_t row) const {
+    // Doble hashing: h1 + row * h2 (h2 impar para recorrer todas las columnas)
+    uint64_t h1 = mix(hash);
+    uint64_t h2 = (hash >> 32 | hash << 32) | 1;
+    return row * (mask_ + 1) + ((h1 + row * h2) & mask_);
+}
+
+void StripeCache::FrequencySketch::add(uint64_t hash) {
+    uint32_t current = estimate(hash);
+    if (current < MAX_COUNT) {
+        // Incremento conservador: solo suben los contadores que tienen el mínimo
+        for (size_t row = 0; row < DEPTH; row++) {
+            uint8_t& counter = counters_[index(hash, row)];
+            if (counter == current) counter++;
+        }
+    }
+    if (++additions_ >= sample_) {
+        for (auto& counter : counters_) counter >>= 1;
+        additions_ /= 2;
+    }
+}
+
+uint32_t StripeCache::FrequencySketch::estimate(uint64_t hash) const {
+    uint32_t result = MAX_COUNT;
+    for (size_t row = 0; row < DEPTH; row++) result = std::min<uint32_t>(result, counters_[index(hash, row)]);
+    return result;
+}
+
+StripeCache::StripeCache(Options options) {
+    // Menos partes en una caché chica, para que en cada una quepan varias franjas
+    size_t entry = std::max<size_t>(1, options.expected_entry_bytes);
+    size_t shards = std::clamp<size_t>(options.capacity_bytes / (8 * entry), 1, std::max<size_t>(1, options.shards));
+    shard_capacity_ = options.capacity_bytes / shards;
+    // El sketch cuenta unas cuantas veces más franjas de las que caben, como en TinyLFU
+    size_t entries = std::max<size_t>(16, shard_capacity_ / entry);
+    size_t width = next_power_of_two(std::max<size_t>(64, 4 * entries));
+    for (size_t i = 0; i < shards; i++) shards_.push_back(std::make_unique<Shard>(width, 10 * entries));
+}
+
+StripeCache::Data StripeCache::get(const std::string& file_id, uint64_t stripe, uint32_t version) {
+    Key key{file_id, stripe};
+    size_t hash = KeyHash{}(key);
+    Shard& s = shard(hash);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.sketch.add(hash);
+    auto it = s.index.find(key);
+    if (it == s.index.end() || it->second->version != version) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    s.lru.splice(s.lru.begin(), s.lru, it->second);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    hit_bytes_.fetch_add(it->second->data->size(), std::memory_order_relaxed);
+    return it->second->data;
+}
+
+uint32_t StripeCache::frequency(const std::string& file_id, uint64_t stripe) const {
+    size_t hash = KeyHash{}(Key{file_id, stripe});
+    Shard& s = shard(hash);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.sketch.estimate(hash);
+}
+
+void StripeCache::put(const std::string& file_id, uint64_t stripe, uint32_t version, Data data) {
+    Key key{file_id, stripe};
+    size_t hash = KeyHash{}(key);
+    size_t bytes = entry_bytes(file_id, data->size());
+    Shard& s = shard(hash);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (bytes > shard_capacity_) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto it = s.index.find(key);
+    if (it != s.index.end()) {
+        // Otra versión de la misma franja: se reemplaza sin pasar por la admisión
+        s.bytes -= it->second->bytes;
+        s.lru.erase(it->second);
+        s.index.erase(it);
+    } else if (s.bytes + bytes > shard_capacity_) {
+        // Se compara con la víctima de la LRU: si la nueva no se pidió más, no entra
+        uint32_t candidate = s.sketch.estimate(hash);
+        uint32_t victim = s.sketch.estimate(KeyHash{}(s.lru.back().key));
+        if (candidate <= victim) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    while (s.bytes + bytes > shard_capacity_) evict(s);
+
+    s.lru.push_front({std::move(key), version, std::move(data), bytes});
+    s.index.emplace(s.lru.front().key, s.lru.begin());
+    s.bytes += bytes;
+    inserted_bytes_.fetch_add(s.lru.front().data->size(), std::memory_order_relaxed);
+}
+
+void StripeCache::evict(Shard& s) {
+    Entry& victim = s.lru.back();
+    s.bytes -= victim.bytes;
+    s.index.erase(victim.key);
+    s.lru.pop_back();
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void StripeCache::invalidate(const std::string& file_id, uint64_t stripe) {
+    Key key{file_id, stripe};
+    Shard& s = shard(KeyHash{}(key));
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.index.find(key);
+    if (it == s.index.end()) return;
+    s.bytes -= it->second->bytes;
+    s.lru.erase(it->second);
+    s.index.erase(it);
+    invalidations_.fetch_add(1, std::memory_order_relaxed);
+}
+
+StripeCache::Stats StripeCache::stats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.hit_bytes = hit_bytes_.load(std::memory_order_relaxed);
+    stats.inserted_bytes = inserted_bytes_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.invalidations = invalidations_.load(std::memory_order_relaxed);
+    for (const auto& s : shards_) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        stats.entries += s->index.size();
+        stats.bytes += s->bytes;
+    }
+    return stats;
+}
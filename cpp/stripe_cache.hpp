@@ -0,0 +1,115 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Caché de franjas ya reconstruidas (datos sin relleno ni compresión), limitada en bytes y
+// dividida en partes con su propio candado. Cada parte es una LRU con admisión TinyLFU: un
+// count-min sketch de 4 bits estima cuántas veces se pidió cada franja (se divide a la mitad
+// cada sample accesos para olvidar lo viejo) y una franja nueva solo entra si se pidió más que
+// la que tendría que desalojar, así una descarga grande de un solo uso no vacía la caché.
+// La versión (el CRC32C de la franja) cambia con cada escritura en sitio: una entrada con otra
+// versión nunca se devuelve, aunque una descarga con metadatos viejos la vuelva a guardar.
+class StripeCache {
+public:
+    using Data = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct Options {
+        size_t capacity_bytes = 256 * 1024 * 1024;
+        size_t shards = 16;                       // máximo; menos si no caben 8 franjas en cada una
+        size_t expected_entry_bytes = 768 * 1024; // para dimensionar las partes y el sketch
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t hit_bytes = 0;      // bytes entregados desde la caché
+        uint64_t inserted_bytes = 0;
+        uint64_t rejected = 0;       // franjas que la admisión dejó afuera
+        uint64_t evictions = 0;
+        uint64_t invalidations = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    explicit StripeCache(Options options);
+
+    StripeCache(const StripeCache&) = delete;
+    StripeCache& operator=(const StripeCache&) = delete;
+
+    // Registra el acceso; nulo si la franja no está o tiene otra versión
+    Data get(const std::string& file_id, uint64_t stripe, uint32_t version);
+
+    // Accesos estimados de la franja (incluido el último get)
+    uint32_t frequency(const std::string& file_id, uint64_t stripe) const;
+
+    // Guarda la franja si la admisión lo permite; desaloja las menos usadas recientemente
+    void put(const std::string& file_id, uint64_t stripe, uint32_t version, Data data);
+
+    void invalidate(const std::string& file_id, uint64_t stripe);
+
+    Stats stats() const;
+
+private:
+    struct Key {
+        std::string file_id;
+        uint64_t stripe;
+        bool operator==(const Key& other) const { return stripe == other.stripe && file_id == other.file_id; }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        Key key;
+        uint32_t version;
+        Data data;
+        size_t bytes;
+    };
+
+    // Count-min sketch con contadores de 4 bits (guardados en un byte)
+    class FrequencySketch {
+    public:
+        FrequencySketch(size_t width, size_t sample);
+        void add(uint64_t hash);
+        uint32_t estimate(uint64_t hash) const;
+
+    private:
+        size_t index(uint64_t hash, size_t row) const;
+
+        static constexpr size_t DEPTH = 4;
+        std::vector<uint8_t> counters_;
+        size_t mask_;
+        size_t sample_;
+        size_t additions_ = 0;
+    };
+
+    struct Shard {
+        Shard(size_t width, size_t sample) : sketch(width, sample) {}
+
+        mutable std::mutex mutex;
+        std::list<Entry> lru; // la más reciente al frente
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+        FrequencySketch sketch;
+        size_t bytes = 0;
+    };
+
+    Shard& shard(uint64_t hash) const { return *shards_[hash % shards_.size()]; }
+    void evict(Shard& s);
+
+    size_t shard_capacity_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> hit_bytes_{0};
+    std::atomic<uint64_t> inserted_bytes_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> invalidations_{0};
+};
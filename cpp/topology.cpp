@@ -0,0 +1,169 @@
+#include "topology.hpp"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <stdexcept>
+#include "durable_file.hpp"
+#include "json.hpp"
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Texto de <tag>...</tag> sin espacios alrededor; vacío si no está
+std::string xml_value(const std::string& xml, const std::string& tag) {
+    size_t open = xml.find("<" + tag + ">");
+    if (open == std::string::npos) return "";
+    size_t begin = open + tag.size() + 2;
+    size_t end = xml.find("</" + tag + ">", begin);
+    if (end == std::string::npos) return "";
+    size_t first = xml.find_first_not_of(" \t\r\n", begin);
+    size_t last = xml.find_last_not_of(" \t\r\n", end - 1);
+    if (first == std::string::npos || first >= end) return "";
+    return xml.substr(first, last - first + 1);
+}
+
+// Compara nombres con los números por valor: node2.xml < node10.xml
+bool natural_less(const std::string& a, const std::string& b) {
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (std::isdigit(static_cast<unsigned char>(a[i])) && std::isdigit(static_cast<unsigned char>(b[j]))) {
+            size_t ei = i, ej = j;
+            while (ei < a.size() && std::isdigit(static_cast<unsigned char>(a[ei]))) ei++;
+            while (ej < b.size() && std::isdigit(static_cast<unsigned char>(b[ej]))) ej++;
+            // Sin convertir a entero, así una tira larga de dígitos no desborda: sin ceros a la
+            // izquierda, el número más corto es el menor y a igual largo decide el orden de los dígitos
+            size_t si = i, sj = j;
+            while (si + 1 < ei && a[si] == '0') si++;
+            while (sj + 1 < ej && b[sj] == '0') sj++;
+            if (ei - si != ej - sj) return ei - si < ej - sj;
+            int order = a.compare(si, ei - si, b, sj, ej - sj);
+            if (order != 0) return order < 0;
+            i = ei;
+            j = ej;
+        } else {
+            if (a[i] != b[j]) return a[i] < b[j];
+            i++;
+            j++;
+        }
+    }
+    return a.size() - i < b.size() - j;
+}
+
+} // namespace
+
+size_t Topology::find(const std::string& url) const {
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].url == url) return i;
+    }
+    return nodes.size();
+}
+
+std::shared_ptr<const Topology> make_topology(uint64_t version, std::vector<NodeInfo> nodes,
+                                              const Topology* previous, size_t ring_width) {
+    auto topology = std::make_shared<Topology>();
+    topology->version = version;
+    topology->nodes = std::move(nodes);
+    for (size_t i = 0; i < topology->nodes.size(); i++) {
+        if (previous && i < previous->size()) topology->counters.push_back(previous->counters[i]);
+        else topology->counters.push_back(std::make_shared<NodeCounters>());
+    }
+    if (ring_width > 0) {
+        std::vector<std::string> urls;
+        std::vector<double> weights;
+        for (const auto& node : topology->nodes) {
+            urls.push_back(node.url);
+            weights.push_back(node.weight);
+        }
+        topology->ring = std::make_shared<NodeRing>(urls, weights, ring_width);
+    }
+    return topology;
+}
+
+NodeRegistry load_node_registry(const std::string& path) {
+    NodeRegistry registry;
+    if (std::string saved = read_file(path); !saved.empty()) {
+        json j = json::parse(saved);
+        registry.version = j.at("version").get<uint64_t>();
+        for (const auto& node : j.at("nodes")) {
+            registry.nodes.push_back({node.at("url").get<std::string>(), node.at("weight").get<double>(),
+                                      node.value("capacity_gb", 0.0), node.value("xml", false)});
+        }
+    }
+    return registry;
+}
+
+size_t merge_nodes(NodeRegistry& registry, const std::vector<NodeInfo>& nodes) {
+    size_t changed = 0;
+    for (const auto& node : nodes) {
+        auto known = std::find_if(registry.nodes.begin(), registry.nodes.end(),
+                                  [&](const NodeInfo& other) { return other.url == node.url; });
+        if (known == registry.nodes.end()) registry.nodes.push_back(node);
+        else if (*known != node) *known = node;
+        else continue;
+        changed++;
+    }
+    if (changed > 0) registry.version++;
+    return changed;
+}
+
+void save_node_registry(const std::string& path, const NodeRegistry& registry) {
+    json nodes = json::array();
+    for (const auto& node : registry.nodes) {
+        nodes.push_back({{"url", node.url}, {"weight", node.weight}, {"capacity_gb", node.capacity_gb},
+                         {"xml", node.from_xml}});
+    }
+    replace_file(path, json{{"version", registry.version}, {"nodes", nodes}}.dump(2));
+}
+
+std::vector<NodeInfo> node_config_changes(const std::vector<NodeInfo>& known, const std::vector<NodeInfo>& loaded) {
+    auto same_url = [](const std::string& url) { return [&url](const NodeInfo& node) { return node.url == url; }; };
+    std::vector<NodeInfo> changes;
+    for (const auto& node : loaded) {
+        auto previous = std::find_if(known.begin(), known.end(), same_url(node.url));
+        if (previous == known.end() || *previous != node) changes.push_back(node);
+    }
+    for (const auto& node : known) {
+        if (!node.from_xml || std::any_of(loaded.begin(), loaded.end(), same_url(node.url))) continue;
+        changes.push_back({node.url, 0, node.capacity_gb, false});
+    }
+    return changes;
+}
+
+std::vector<NodeInfo> load_node_configs(const std::string& dir) {
+    std::vector<fs::path> files;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".xml") files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end(), [](const fs::path& a, const fs::path& b) {
+        return natural_less(a.filename().string(), b.filename().string());
+    });
+
+    std::vector<NodeInfo> nodes;
+    for (const auto& file : files) {
+        std::string xml = read_file(file.string());
+        std::string ip = xml_value(xml, "ip");
+        std::string port = xml_value(xml, "port");
+        if (ip.empty() || port.empty()) throw std::runtime_error(file.string() + " has no <ip> or <port>");
+        if (ip == "0.0.0.0") ip = "127.0.0.1";
+        NodeInfo node;
+        node.url = "http://" + ip + ":" + port;
+        node.from_xml = true;
+        try {
+            std::string capacity = xml_value(xml, "capacity_gb");
+            std::string weight = xml_value(xml, "weight");
+            if (!capacity.empty()) node.capacity_gb = std::stod(capacity);
+            if (!weight.empty()) node.weight = std::stod(weight);
+            else if (node.capacity_gb > 0) node.weight = node.capacity_gb / 1024;
+        } catch (const std::exception&) {
+            throw std::runtime_error(file.string() + " has an invalid <weight> or <capacity_gb>");
+        }
+        if (node.weight < 0 || node.capacity_gb < 0) {
+            throw std::runtime_error(file.string() + " has a negative <weight> or <capacity_gb>");
+        }
+        nodes.push_back(std::move(node));
+    }
+    return nodes;
+}
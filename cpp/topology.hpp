@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "node_ring.hpp"
+
+// Un Disk Node conocido por el controlador
+struct NodeInfo {
+    std::string url;
+    double weight = 1;      // parte de las franjas nuevas con placement "hashed" (0: ninguna)
+    double capacity_gb = 0; // espacio del disco según su configuración (0: no se sabe)
+    bool from_xml = false;  // descrito por un XML de node_config_dir (y no solo por POST /nodes)
+
+    bool operator==(const NodeInfo& other) const = default;
+};
+
+// Unidades y bytes escritos en un nodo; se comparten entre topologías sucesivas
+struct NodeCounters {
+    std::atomic<uint64_t> write_units{0};
+    std::atomic<uint64_t> write_bytes{0};
+};
+
+// Nodos del clúster en un momento dado. Es inmutable: al registrar un nodo o cambiar un peso se
+// arma otra y se publica entera, y quien tomó la anterior la sigue usando hasta terminar. Los
+// nodos solo se agregan al final, porque los metadatos de cada franja guardan su índice.
+struct Topology {
+    uint64_t version = 0;
+    std::vector<NodeInfo> nodes;
+    std::vector<std::shared_ptr<NodeCounters>> counters; // uno por nodo
+    std::shared_ptr<const NodeRing> ring; // nulo salvo con placement "hashed"
+
+    size_t size() const { return nodes.size(); }
+
+    // Índice del nodo con esa URL; size() si no está
+    size_t find(const std::string& url) const;
+};
+
+// Arma la topología con nodes, conservando los contadores de previous (si hay) para los nodos
+// que ya estaban. ring_width es k + m con placement "hashed" y 0 sin anillo; lanza si el anillo
+// no se puede armar (menos de ring_width nodos con peso).
+std::shared_ptr<const Topology> make_topology(uint64_t version, std::vector<NodeInfo> nodes,
+                                              const Topology* previous, size_t ring_width);
+
+// Registro persistente de los nodos (<metadata_dir>/nodes.json). Fija el índice de cada nodo:
+// la primera vez se arma con los de la configuración y después solo se le agregan al final los
+// nodos nuevos (de la configuración o de POST /nodes); los demás cambios son de peso o capacidad.
+struct NodeRegistry {
+    uint64_t version = 0;
+    std::vector<NodeInfo> nodes;
+};
+
+// Registro vacío (versión 0) si todavía no se guardó
+NodeRegistry load_node_registry(const std::string& path);
+
+// Agrega al final los nodos que falten (por URL) y actualiza el peso y la capacidad de los que
+// ya estaban; sube la versión si algo cambió y devuelve cuántos nodos cambiaron
+size_t merge_nodes(NodeRegistry& registry, const std::vector<NodeInfo>& nodes);
+
+void save_node_registry(const std::string& path, const NodeRegistry& registry);
+
+// Cambios que llevan de los nodos known a los XML loaded: los nodos nuevos o modificados, y con
+// peso 0 los que venían de un XML que ya no está (se vacían; no se quitan porque los metadatos
+// guardan su índice). Los nodos de known que no vienen de un XML no se tocan.
+std::vector<NodeInfo> node_config_changes(const std::vector<NodeInfo>& known, const std::vector<NodeInfo>& loaded);
+
+// Nodos descritos por los XML de dir (los que genera python/generate_xml.py), en orden natural
+// de nombre (node2 antes que node10):
+//   <config><ip>..</ip><port>..</port><path>..</path>
+//           <weight>..</weight><capacity_gb>..</capacity_gb></config>
+// weight y capacity_gb son opcionales; sin weight, el peso es la capacidad en TiB (como los
+// pesos de CRUSH) y 1 si tampoco hay capacidad. La ip 0.0.0.0 (escuchar en todas las
+// interfaces) se contacta como 127.0.0.1. Vacío si no hay XML; lanza si uno es inválido.
+std::vector<NodeInfo> load_node_configs(const std::string& dir);
@@ -1,7 +1,7 @@
 import os
 import sys
 import xml.etree.ElementTree as ET
-from flask import Flask, request, jsonify
+from flask import Flask, request, jsonify, Response
 import base64
 from flask_cors import CORS
 
@@ -31,41 +31,88 @@ def load_config(config_path): # Toma una ruta de archivo XML como entrada
         'path': storage_path
     }
 
+def save_block(block_id, byte_data):
+    """Store block bytes in memory and, if configured, on disk"""
+    #2 modos de almacenamiento
+    #Depende de si se asigna una ruta de disco válida o no
+    # Almacena en memoria (STORAGE)
+    STORAGE[block_id] = byte_data
+
+    # Almacena en disco como .bin, si STORAGE_PATH está configurado
+    storage_path = app.config.get('STORAGE_PATH', '')
+    if storage_path:
+        file_path = os.path.join(storage_path, f"{block_id}.bin")
+        with open(file_path, 'wb') as f:
+            f.write(byte_data)
+
+def load_block(block_id):
+    """Return block bytes or None if the block does not exist"""
+    # Primero en memoria (STORAGE)
+    if block_id in STORAGE:
+        return STORAGE[block_id]
+
+    # Luego en disco (si STORAGE_PATH existe)
+    storage_path = app.config.get('STORAGE_PATH', '')
+    if storage_path:
+        file_path = os.path.join(storage_path, f"{block_id}.bin")
+        if os.path.exists(file_path):
+            with open(file_path, 'rb') as f:
+                return f.read()
+    return None
+
+def remove_block(block_id):
+    """Remove block bytes from memory and disk; False if the block does not exist"""
+    found = STORAGE.pop(block_id, None) is not None
+
+    storage_path = app.config.get('STORAGE_PATH', '')
+    if storage_path:
+        file_path = os.path.join(storage_path, f"{block_id}.bin")
+        if os.path.exists(file_path):
+            os.remove(file_path)
+            found = True
+    return found
+
+def wants_binary():
+    """True if the client asked for raw bytes instead of JSON"""
+    return 'application/octet-stream' in request.headers.get('Accept', '')
+
 @app.route('/store', methods=['POST'])
 def store_block():
     """Store a data block with the given ID"""
-    try: # Valida que la petición sea JSON y tenga los campos 'id' y 'data'
-        if not request.is_json:
-            return jsonify({"error": "Request must be JSON"}), 400
-
-        data = request.get_json()
-        if not data or 'id' not in data or 'data' not in data:
-            return jsonify({"error": "Missing 'id' or 'data' in request"}), 400
-
-        block_id = data['id']
-        block_data = data['data']
-
-        # Verifica que los datos sean una lista de bytes válidos (números 0-255)
-        if not isinstance(block_data, list):
-            return jsonify({"error": "Data must be a list of bytes"}), 400
-
-        try:
-            # Convierte la lista a bytes y almacena
-            byte_data = bytes(block_data)
-        except (ValueError, TypeError):
-            return jsonify({"error": "Invalid byte values in data"}), 400
-
-        #2 modos de almacenamiento
-        #Depende de si se asigna una ruta de disco válida o no
-        # Almacena en memoria (STORAGE)
-        STORAGE[block_id] = byte_data
-
-        # Almacena en disco como .bin, si STORAGE_PATH está configurado
-        storage_path = app.config.get('STORAGE_PATH', '')
-        if storage_path:
-            file_path = os.path.join(storage_path, f"{block_id}.bin")
-            with open(file_path, 'wb') as f:
-                f.write(byte_data)
+    try:
+        # Formato binario: cuerpo crudo, id y longitud en los encabezados
+        if request.mimetype == 'application/octet-stream':
+            block_id = request.headers.get('X-Block-Id')
+            if not block_id:
+                return jsonify({"error": "Missing X-Block-Id header"}), 400
+
+            byte_data = request.get_data()
+            expected = request.headers.get('X-Block-Length')
+            if expected is not None and int(expected) != len(byte_data):
+                return jsonify({"error": "Block length mismatch"}), 400
+        else:
+            # Formato JSON: valida que tenga los campos 'id' y 'data'
+            if not request.is_json:
+                return jsonify({"error": "Request must be JSON or application/octet-stream"}), 400
+
+            data = request.get_json()
+            if not data or 'id' not in data or 'data' not in data:
+                return jsonify({"error": "Missing 'id' or 'data' in request"}), 400
+
+            block_id = data['id']
+            block_data = data['data']
+
+            # Verifica que los datos sean una lista de bytes válidos (números 0-255)
+            if not isinstance(block_data, list):
+                return jsonify({"error": "Data must be a list of bytes"}), 400
+
+            try:
+                # Convierte la lista a bytes
+                byte_data = bytes(block_data)
+            except (ValueError, TypeError):
+                return jsonify({"error": "Invalid byte values in data"}), 400
+
+        save_block(block_id, byte_data)
         # Retorna éxito o error
         return jsonify({
             "status": "success",
@@ -80,26 +127,36 @@ def store_block():
 def retrieve_block(block_id): # Busca un bloque por su ID
     """Retrieve a stored block by ID"""
     try:
-        # Primero en memoria (STORAGE)
-        if block_id in STORAGE:
-            return jsonify({
-                "id": block_id,
-                "data": list(STORAGE[block_id])  # Convert bytes to list of ints
-            }), 200
-
-        # Luego en disco (si STORAGE_PATH existe)
-        storage_path = app.config.get('STORAGE_PATH', '')
-        if storage_path:
-            file_path = os.path.join(storage_path, f"{block_id}.bin")
-            if os.path.exists(file_path):
-                with open(file_path, 'rb') as f:
-                    data = f.read()
-                return jsonify({
-                    "id": block_id,
-                    "data": list(data)  # Si lo encuentra, retorna los datos como lista de bytes en JSON
-                }), 200
-
-        return jsonify({"error": "Block not found"}), 404 # Si no, retorna error 404
+        data = load_block(block_id)
+        if data is None:
+            return jsonify({"error": "Block not found"}), 404 # Si no, retorna error 404
+
+        # Si el cliente acepta binario, devuelve los bytes sin convertir
+        if wants_binary():
+            return Response(data, mimetype='application/octet-stream', headers={
+                "X-Block-Id": block_id,
+                "X-Block-Length": str(len(data))
+            })
+
+        return jsonify({
+            "id": block_id,
+            "data": list(data)  # Convert bytes to list of ints
+        }), 200
+
+    except Exception as e:
+        return jsonify({"error": str(e)}), 500
+
+@app.route('/block/<block_id>', methods=['DELETE'])
+def delete_block(block_id): # Borra un bloque que se mudó a otro nodo
+    """Delete a stored block by ID"""
+    try:
+        if not remove_block(block_id):
+            return jsonify({"error": "Block not found"}), 404
+
+        return jsonify({
+            "status": "success",
+            "id": block_id
+        }), 200
 
     except Exception as e:
         return jsonify({"error": str(e)}), 500
@@ -129,8 +186,9 @@ if __name__ == '__main__':
         print(f"Starting Disk Node at {config['ip']}:{config['port']}")
         print(f"Storage path: {config['path']}")
         print(f"Available endpoints:")
-        print(f"  POST /store - Store a data block")
+        print(f"  POST /store - Store a data block (JSON or application/octet-stream)")
         print(f"  GET  /retrieve/<id> - Retrieve a block")
+        print(f"  DELETE /block/<id> - Delete a block")
         print(f"  GET  /status - Health check")
         # Inicia el servidor Flask con los parámetros del XML
         app.run(host=config['ip'], port=config['port'], threaded=True)
@@ -1,12 +1,17 @@
 import os
 import xml.etree.ElementTree as ET
 
-def create_node_config(project_root, node_id, port):
+def create_node_config(project_root, node_id, port, weight=1, capacity_gb=None):
     """Creates XML config for a Disk Node with absolute paths"""
     config = ET.Element("config")
     ET.SubElement(config, "ip").text = "0.0.0.0"
     ET.SubElement(config, "port").text = str(port)
 
+    # share of the stripes the controller places on this node (re-read while it runs)
+    ET.SubElement(config, "weight").text = str(weight)
+    if capacity_gb is not None:
+        ET.SubElement(config, "capacity_gb").text = str(capacity_gb)
+
     # define paths relative to root
     storage_path = os.path.abspath(os.path.join(project_root, "storage", f"node{node_id}"))
     ET.SubElement(config, "path").text = storage_path
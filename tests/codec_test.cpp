@@ -0,0 +1,266 @@
+// Pruebas de los kernels de bajo nivel: codificación y reconstrucción de los codecs con todos
+// los patrones de pérdida de hasta m unidades, paridad por delta, XOR de muchos bloques,
+// ida y vuelta de LZ4 y vectores conocidos de CRC32C. ctest lo corre una vez por cada nivel
+// de PROYECTO_SIMD; el argumento es ese nivel y, si la CPU no lo tiene, la prueba se salta.
+//   CodecTest [scalar|sse2|avx2|avx512]
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "compression.hpp"
+#include "cpu_features.hpp"
+#include "crc32c.hpp"
+#include "erasure.hpp"
+#include "gf256.hpp"
+#include "parity.hpp"
+
+using ByteBlock = std::vector<uint8_t>;
+using Blocks = std::vector<ByteBlock>;
+
+constexpr int SKIPPED = 77; // SKIP_RETURN_CODE en CMakeLists.txt
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (ok) return;
+    std::cerr << "FAIL: " << what << "\n";
+    failures++;
+}
+
+Blocks random_blocks(std::mt19937& rng, size_t count, size_t len) {
+    Blocks blocks(count, ByteBlock(len));
+    for (auto& block : blocks) {
+        for (auto& byte : block) byte = static_cast<uint8_t>(rng());
+    }
+    return blocks;
+}
+
+// Recorre todos los subconjuntos de {0..n-1} con 1..max_lost elementos
+template <class Fn>
+void for_each_loss(size_t n, size_t max_lost, Fn fn) {
+    std::vector<bool> present(n, true);
+    auto recurse = [&](auto& self, size_t from, size_t lost) -> void {
+        if (lost > 0) fn(present);
+        if (lost == max_lost) return;
+        for (size_t i = from; i < n; i++) {
+            present[i] = false;
+            self(self, i + 1, lost + 1);
+            present[i] = true;
+        }
+    };
+    recurse(recurse, 0, 0);
+}
+
+void test_codec(const std::string& name, size_t k, size_t m, size_t len, std::mt19937& rng) {
+    std::unique_ptr<ErasureCodec> codec = make_codec(name, k, m);
+    std::string label = name + " " + std::to_string(k) + "+" + std::to_string(m) + " len " + std::to_string(len);
+    size_t n = k + m;
+
+    Blocks shards = random_blocks(rng, k, len);
+    shards.resize(n, ByteBlock(len));
+    std::vector<const uint8_t*> data;
+    std::vector<uint8_t*> parity;
+    for (size_t i = 0; i < k; i++) data.push_back(shards[i].data());
+    for (size_t j = 0; j < m; j++) parity.push_back(shards[k + j].data());
+    codec->encode(data.data(), parity.data(), len);
+
+    // La paridad XOR se puede comprobar directamente
+    if (name == "xor") {
+        ByteBlock expected(len, 0);
+        for (size_t i = 0; i < k; i++) {
+            for (size_t b = 0; b < len; b++) expected[b] ^= shards[i][b];
+        }
+        check(expected == shards[k], label + ": xor parity");
+    }
+
+    for (bool data_only : {false, true}) {
+        for_each_loss(n, m, [&](const std::vector<bool>& present) {
+            Blocks damaged = shards;
+            std::vector<uint8_t*> ptrs;
+            for (size_t i = 0; i < n; i++) {
+                if (!present[i]) std::fill(damaged[i].begin(), damaged[i].end(), 0xa5);
+                ptrs.push_back(damaged[i].data());
+            }
+            codec->reconstruct(ptrs.data(), present, len, data_only);
+            size_t checked = data_only ? k : n;
+            for (size_t i = 0; i < checked; i++) {
+                if (damaged[i] == shards[i]) continue;
+                std::string lost;
+                for (size_t s = 0; s < n; s++) {
+                    if (!present[s]) lost += " " + std::to_string(s);
+                }
+                check(false, label + ": shard " + std::to_string(i) + " wrong after losing" + lost +
+                             (data_only ? " (data only)" : ""));
+                return;
+            }
+        });
+    }
+
+    // update_parity con el delta de un dato tiene que dar lo mismo que volver a codificar
+    size_t index = rng() % k;
+    ByteBlock updated = random_blocks(rng, 1, len)[0];
+    ByteBlock delta(len);
+    for (size_t b = 0; b < len; b++) delta[b] = shards[index][b] ^ updated[b];
+    Blocks patched(shards.begin() + k, shards.end());
+    std::vector<uint8_t*> patched_ptrs;
+    for (auto& block : patched) patched_ptrs.push_back(block.data());
+    codec->update_parity(index, delta.data(), patched_ptrs.data(), len);
+    shards[index] = updated;
+    data[index] = shards[index].data();
+    codec->encode(data.data(), parity.data(), len);
+    for (size_t j = 0; j < m; j++) check(patched[j] == shards[k + j], label + ": update_parity of parity " + std::to_string(j));
+}
+
+// gf_dot contra el producto escalar calculado byte a byte con gf_mul
+void test_gf_dot(std::mt19937& rng) {
+    for (size_t count : {1, 3, 7}) {
+        for (size_t len : {1, 15, 64, 129, 1000}) {
+            Blocks srcs = random_blocks(rng, count, len);
+            std::vector<const uint8_t*> ptrs;
+            std::vector<uint8_t> coeffs;
+            for (auto& src : srcs) {
+                ptrs.push_back(src.data());
+                coeffs.push_back(static_cast<uint8_t>(rng()));
+            }
+            std::vector<uint8_t> tables(32 * count);
+            gf_build_tables(coeffs.data(), count, tables.data());
+            ByteBlock out(len, 0xee);
+            gf_dot(out.data(), ptrs.data(), tables.data(), count, len);
+            ByteBlock expected(len, 0);
+            for (size_t s = 0; s < count; s++) {
+                for (size_t b = 0; b < len; b++) expected[b] ^= gf_mul(coeffs[s], srcs[s][b]);
+            }
+            check(out == expected, "gf_dot count " + std::to_string(count) + " len " + std::to_string(len));
+
+            ByteBlock acc = expected;
+            gf_mul_add(acc.data(), srcs[0].data(), tables.data(), len);
+            for (size_t b = 0; b < len; b++) expected[b] ^= gf_mul(coeffs[0], srcs[0][b]);
+            check(acc == expected, "gf_mul_add len " + std::to_string(len));
+        }
+    }
+    for (int a = 1; a < 256; a++) check(gf_mul(static_cast<uint8_t>(a), gf_inv(static_cast<uint8_t>(a))) == 1, "gf_inv");
+}
+
+// Más de 64 fuentes pasan por el camino que divide el XOR en tandas
+void test_xor_blocks(std::mt19937& rng) {
+    for (size_t count : {1, 2, 5, 64, 65, 130}) {
+        size_t len = 300;
+        Blocks srcs = random_blocks(rng, count, len);
+        std::vector<const uint8_t*> ptrs;
+        for (auto& src : srcs) ptrs.push_back(src.data());
+        ByteBlock out(len);
+        xor_blocks(out.data(), ptrs.data(), count, len);
+        ByteBlock expected(len, 0);
+        for (auto& src : srcs) {
+            for (size_t b = 0; b < len; b++) expected[b] ^= src[b];
+        }
+        check(out == expected, "xor_blocks count " + std::to_string(count));
+    }
+}
+
+void lz4_round_trip(const ByteBlock& input, const std::string& label) {
+    ByteBlock compressed(lz4_bound(input.size()));
+    size_t n = lz4_compress(input.data(), input.size(), compressed.data(), compressed.size());
+    check(n > 0, label + ": lz4_compress");
+    if (n == 0) return;
+    ByteBlock output(input.size());
+    check(lz4_decompress(compressed.data(), n, output.data(), output.size()) && output == input,
+          label + ": lz4 round trip");
+    // Un largo distinto del original o un bloque truncado se rechazan
+    ByteBlock longer(input.size() + 1);
+    check(!lz4_decompress(compressed.data(), n, longer.data(), longer.size()), label + ": lz4 wrong length");
+    if (n > 1) check(!lz4_decompress(compressed.data(), n - 1, output.data(), output.size()), label + ": lz4 truncated");
+}
+
+void test_lz4(std::mt19937& rng) {
+    std::string text;
+    while (text.size() < 200000) text += "Proyecto III: stripe " + std::to_string(text.size() % 977) + " of file_x\n";
+    ByteBlock repetitive(text.begin(), text.end());
+    lz4_round_trip(repetitive, "text");
+    lz4_round_trip(ByteBlock(100000, 0), "zeros");
+    lz4_round_trip(random_blocks(rng, 1, 70000)[0], "random");
+    for (size_t len : {1, 5, 12, 13, 17, 255, 270}) {
+        lz4_round_trip(ByteBlock(repetitive.begin(), repetitive.begin() + len), "text len " + std::to_string(len));
+    }
+    // Coincidencias más lejanas que MAX_OFFSET no pueden referenciarse
+    ByteBlock far = random_blocks(rng, 1, 70000)[0];
+    far.insert(far.end(), far.begin(), far.begin() + 70000);
+    lz4_round_trip(far, "far repeat");
+
+    ByteBlock compressed(lz4_bound(repetitive.size()));
+    size_t n = lz4_compress(repetitive.data(), repetitive.size(), compressed.data(), compressed.size());
+    check(n < repetitive.size() / 4, "lz4 compresses repetitive text");
+    check(worth_compressing(repetitive.data(), repetitive.size()), "worth_compressing text");
+    ByteBlock noise = random_blocks(rng, 1, 100000)[0];
+    check(!worth_compressing(noise.data(), noise.size()), "worth_compressing random");
+}
+
+// Vectores de RFC 3720 (iSCSI) y el "123456789" habitual
+void test_crc32c(std::mt19937& rng) {
+    const char* digits = "123456789";
+    check(crc32c(reinterpret_cast<const uint8_t*>(digits), 9) == 0xe3069283u, "crc32c 123456789");
+    ByteBlock block(32, 0);
+    check(crc32c(block.data(), 32) == 0x8a9136aau, "crc32c 32 zeros");
+    check(crc32c_zeros(32) == 0x8a9136aau, "crc32c_zeros 32");
+    std::fill(block.begin(), block.end(), 0xff);
+    check(crc32c(block.data(), 32) == 0x62a8ab43u, "crc32c 32 x 0xff");
+    for (size_t i = 0; i < 32; i++) block[i] = static_cast<uint8_t>(i);
+    check(crc32c(block.data(), 32) == 0x46dd794eu, "crc32c 0..31");
+    for (size_t i = 0; i < 32; i++) block[i] = static_cast<uint8_t>(31 - i);
+    check(crc32c(block.data(), 32) == 0x113fdb5cu, "crc32c 31..0");
+
+    ByteBlock data = random_blocks(rng, 1, 10000)[0];
+    uint32_t whole = crc32c(data.data(), data.size());
+    for (size_t split : {0, 1, 7, 64, 4097, 10000}) {
+        uint32_t a = crc32c(data.data(), split);
+        uint32_t b = crc32c(data.data() + split, data.size() - split);
+        check(crc32c(data.data() + split, data.size() - split, a) == whole, "crc32c continued at " + std::to_string(split));
+        check(crc32c_combine(a, b, data.size() - split) == whole, "crc32c_combine at " + std::to_string(split));
+    }
+    for (size_t len : {0, 1, 100, 65536}) {
+        ByteBlock zeros(len, 0);
+        check(crc32c_zeros(len) == crc32c(zeros.data(), len), "crc32c_zeros " + std::to_string(len));
+    }
+}
+
+// true si el nivel pedido es el que quedó elegido (la CPU lo tiene)
+bool tier_selected(const std::string& tier) {
+    std::string gf = gf_kernel_name();
+    std::string parity = parity_kernel_name();
+    if (tier == "scalar") return gf == "scalar" && parity == "scalar" && std::string(crc32c_kernel_name()) == "scalar";
+    if (tier == "sse2") return gf == "ssse3" && parity == "sse2";
+    return gf == tier && parity == tier;
+}
+
+int main(int argc, char** argv) {
+    std::string tier = argc > 1 ? argv[1] : "";
+    std::cout << "Kernels: parity " << parity_kernel_name() << ", gf " << gf_kernel_name() << ", crc32c "
+              << crc32c_kernel_name() << "\n";
+    if (!tier.empty() && (simd_override() != tier || !tier_selected(tier))) {
+        std::cout << "CPU does not support " << tier << " (or PROYECTO_SIMD is not set to it), skipping\n";
+        return SKIPPED;
+    }
+
+    std::mt19937 rng(12345);
+    // Largos que ejercitan el cuerpo de cada kernel (16 a 128 bytes por vuelta) y sus colas
+    for (size_t len : {1, 31, 200, 4099}) {
+        test_codec("xor", 1, 1, len, rng);
+        test_codec("xor", 4, 1, len, rng);
+        test_codec("rs", 3, 2, len, rng);
+        test_codec("rs", 4, 3, len, rng);
+    }
+    test_codec("rs", 10, 4, 1000, rng);
+    test_codec("rs", 2, 6, 257, rng);
+    test_gf_dot(rng);
+    test_xor_blocks(rng);
+    test_lz4(rng);
+    test_crc32c(rng);
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "All checks passed\n";
+    return 0;
+}
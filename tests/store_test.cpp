@@ -0,0 +1,361 @@
+// Pruebas de recuperación de los archivos del controlador: escribe con la API, corta o altera
+// los archivos en disco como lo dejaría una caída y vuelve a abrirlos para revisar lo que quedó.
+// Cubre el log y los snapshots de MetadataStore, chunks.log de ChunkIndex, patch.journal y el
+// generador de ids. Trabaja en una carpeta temporal que borra al terminar.
+//   StoreTest [carpeta]
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "chunk_index.hpp"
+#include "durable_file.hpp"
+#include "file_id.hpp"
+#include "metadata_store.hpp"
+#include "patch_journal.hpp"
+
+namespace fs = std::filesystem;
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (ok) return;
+    std::cerr << "FAIL: " << what << "\n";
+    failures++;
+}
+
+void write_file(const fs::path& path, const std::string& data) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+// Carpeta vacía para una prueba
+std::string fresh_dir(const fs::path& root, const std::string& name) {
+    fs::path dir = root / name;
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir.string();
+}
+
+FileMetadata make_meta(size_t size) {
+    FileMetadata meta;
+    meta.layout.file_size = size;
+    meta.layout.k = 3;
+    meta.layout.m = 1;
+    meta.layout.stripe_unit = 4096;
+    meta.checksums = {static_cast<uint32_t>(size), 1, 2, 3};
+    return meta;
+}
+
+bool has_size(const MetadataStore& store, const std::string& file_id, size_t size) {
+    auto meta = store.get(file_id);
+    return meta && meta->size() == size;
+}
+
+// Un put cortado a la mitad se descarta; los anteriores quedan y el log sigue desde ahí
+void test_metadata_torn_tail(const fs::path& root) {
+    MetadataStore::Options options{fresh_dir(root, "metadata_torn"), 1 << 30};
+    fs::path wal = fs::path(options.dir) / "wal.log";
+    {
+        MetadataStore store(options);
+        store.put("a", make_meta(100));
+        store.put("b", make_meta(200));
+    }
+    uintmax_t complete = fs::file_size(wal);
+    {
+        MetadataStore store(options);
+        store.put("c", make_meta(300));
+    }
+    fs::resize_file(wal, fs::file_size(wal) - 5);
+    {
+        MetadataStore store(options);
+        check(has_size(store, "a", 100) && has_size(store, "b", 200), "metadata: records before a torn tail survive");
+        check(!store.get("c"), "metadata: torn record is discarded");
+        check(fs::file_size(wal) == complete, "metadata: torn tail is truncated from wal.log");
+        check(store.stats().files == 2, "metadata: file count after torn tail");
+        store.put("d", make_meta(400));
+    }
+    // Basura que no es un registro válido tampoco tapa lo escrito antes
+    std::string log = read_file(wal.string());
+    write_file(wal, log + std::string(64, '\x7f'));
+    {
+        MetadataStore store(options);
+        check(has_size(store, "d", 400), "metadata: record written after truncation is replayed");
+        check(fs::file_size(wal) == log.size(), "metadata: garbage after the log is truncated");
+    }
+}
+
+// Si el proceso cae entre escribir el snapshot y vaciar el log, los registros del log que el
+// snapshot ya incluye (seq menor o igual) no deben pisar lo más nuevo
+void test_metadata_snapshot_replay(const fs::path& root) {
+    MetadataStore::Options options{fresh_dir(root, "metadata_snapshot"), 1 << 30};
+    fs::path wal = fs::path(options.dir) / "wal.log";
+    {
+        MetadataStore store(options);
+        store.put("a", make_meta(100));
+        store.put("b", make_meta(200));
+    }
+    std::string old_log = read_file(wal.string());
+
+    options.compact_bytes = 1; // el próximo put compacta
+    {
+        MetadataStore store(options);
+        store.put("a", make_meta(111));
+    }
+    check(fs::file_size(wal) == 0, "metadata: compaction empties wal.log");
+    size_t snapshots = 0;
+    for (const auto& item : fs::directory_iterator(options.dir)) {
+        if (item.path().filename().string().rfind("snapshot-", 0) == 0) snapshots++;
+    }
+    check(snapshots == 1, "metadata: compaction leaves one snapshot");
+
+    write_file(wal, old_log);
+    options.compact_bytes = 1 << 30;
+    {
+        MetadataStore store(options);
+        check(has_size(store, "a", 111), "metadata: log records already in the snapshot are skipped");
+        check(has_size(store, "b", 200), "metadata: snapshot keeps older records");
+        check(store.stats().files == 2, "metadata: file count after snapshot + log");
+        // Los seq siguen después de los del log viejo, así que este put sobrevive al reabrir
+        store.put("b", make_meta(222));
+        store.put("c", make_meta(300));
+    }
+    {
+        MetadataStore store(options);
+        check(has_size(store, "b", 222) && has_size(store, "c", 300), "metadata: puts after snapshot replay persist");
+        std::vector<std::string> ids = store.file_ids();
+        check(ids == std::vector<std::string>({"a", "b", "c"}), "metadata: file_ids after snapshot + log");
+    }
+}
+
+Fingerprint make_fp(uint32_t n) {
+    Fingerprint fp;
+    fp.words[0] = n;
+    fp.words[1] = n * 2654435761u;
+    fp.words[2] = ~n;
+    return fp;
+}
+
+// Reproduce chunks.log sin snapshot y descarta un registro a medio escribir
+void test_chunk_log_replay(const fs::path& root) {
+    ChunkIndex::Options options{fresh_dir(root, "chunks_replay"), 1 << 30};
+    fs::path log = fs::path(options.dir) / "chunks.log";
+    {
+        ChunkIndex index(options);
+        index.commit("file_a", {{make_fp(1), 0, 1000, 2}, {make_fp(2), 1000, 500, 1}}, {});
+        index.commit("file_b", {{make_fp(3), 0, 700, 1}}, {make_fp(1)});
+    }
+    uintmax_t complete = fs::file_size(log);
+    {
+        ChunkIndex index(options);
+        index.commit("file_c", {}, {make_fp(2)}); // un solo registro OP_REF
+    }
+    fs::resize_file(log, fs::file_size(log) - 3);
+    {
+        ChunkIndex index(options);
+        auto first = index.find(make_fp(1));
+        check(first && first->container == "file_a" && first->offset == 0 && first->length == 1000,
+              "chunks: replayed location of the first chunk");
+        auto third = index.find(make_fp(3));
+        check(third && third->container == "file_b" && third->length == 700, "chunks: replayed second container");
+        ChunkIndex::Stats stats = index.stats();
+        check(stats.chunks == 3 && stats.containers == 2, "chunks: entries and containers after replay");
+        check(stats.references == 5, "chunks: references of a torn upload are discarded");
+        check(stats.stored_bytes == 2200, "chunks: stored bytes after replay");
+        check(fs::file_size(log) == complete, "chunks: torn tail is truncated from chunks.log");
+    }
+}
+
+// Logs anteriores a OP_REF podían registrar dos veces la misma huella con OP_ADD: la segunda
+// suma sus referencias a la primera ubicación
+void test_chunk_duplicate_add(const fs::path& root) {
+    ChunkIndex::Options options{fresh_dir(root, "chunks_duplicate"), 1 << 30};
+    // Mismos valores que las constantes de chunk_index.cpp
+    constexpr uint8_t OP_CONTAINER = 1, OP_ADD = 2;
+    auto container = [](uint64_t seq, uint32_t index, const std::string& id) {
+        std::string payload;
+        append_int<uint8_t>(payload, OP_CONTAINER);
+        append_int<uint64_t>(payload, seq);
+        append_int<uint32_t>(payload, index);
+        append_int<uint16_t>(payload, static_cast<uint16_t>(id.size()));
+        payload += id;
+        return payload;
+    };
+    // Entrada de 28 bytes: huella, contenedor, offset bajo, offset alto y largo, referencias
+    auto add = [](uint64_t seq, const Fingerprint& fp, uint32_t index, uint32_t offset, uint32_t length,
+                  uint32_t refs) {
+        std::string payload;
+        append_int<uint8_t>(payload, OP_ADD);
+        append_int<uint64_t>(payload, seq);
+        append_int<Fingerprint>(payload, fp);
+        append_int<uint32_t>(payload, index);
+        append_int<uint32_t>(payload, offset);
+        append_int<uint32_t>(payload, length);
+        append_int<uint32_t>(payload, refs);
+        return payload;
+    };
+    std::string log;
+    append_record(log, container(1, 0, "file_a"));
+    append_record(log, add(1, make_fp(1), 0, 0, 1000, 1));
+    append_record(log, container(2, 1, "file_b"));
+    append_record(log, add(2, make_fp(1), 1, 4096, 1000, 2));
+    append_record(log, add(2, make_fp(2), 1, 0, 600, 1));
+    write_file(fs::path(options.dir) / "chunks.log", log);
+
+    ChunkIndex index(options);
+    auto location = index.find(make_fp(1));
+    check(location && location->container == "file_a" && location->offset == 0,
+          "chunks: duplicate OP_ADD keeps the first location");
+    ChunkIndex::Stats stats = index.stats();
+    check(stats.chunks == 2, "chunks: duplicate OP_ADD is one entry");
+    check(stats.references == 4, "chunks: duplicate OP_ADD folds its references");
+    check(stats.stored_bytes == 1600, "chunks: duplicate OP_ADD does not count its bytes");
+
+    // La subida siguiente sigue después del último seq del log
+    index.commit("file_c", {{make_fp(3), 0, 200, 1}}, {make_fp(1)});
+    ChunkIndex reopened(options);
+    check(reopened.find(make_fp(3)) && reopened.stats().references == 6, "chunks: commit after folded replay persists");
+}
+
+StripePatch make_patch(const std::string& file_id, uint64_t stripe, uint8_t fill) {
+    StripePatch patch;
+    patch.file_id = file_id;
+    patch.stripe = stripe;
+    patch.units = {0, 3};
+    patch.contents = {std::vector<uint8_t>(100, fill), std::vector<uint8_t>(100, static_cast<uint8_t>(fill ^ 0xff))};
+    patch.checksums = {fill, static_cast<uint32_t>(fill) + 1};
+    patch.stripe_checksum = 1000 + fill;
+    return patch;
+}
+
+bool same_patch(const StripePatch& a, const StripePatch& b) {
+    return a.file_id == b.file_id && a.stripe == b.stripe && a.units == b.units && a.contents == b.contents &&
+           a.checksums == b.checksums && a.stripe_checksum == b.stripe_checksum;
+}
+
+// Las franjas sin end() se reproducen al reabrir; un begin() cortado se descarta
+void test_patch_journal_replay(const fs::path& root) {
+    std::string dir = fresh_dir(root, "journal_replay");
+    fs::path path = fs::path(dir) / "patch.journal";
+    uint64_t second;
+    {
+        PatchJournal journal(dir);
+        uint64_t first = journal.begin(make_patch("file_a", 0, 1));
+        second = journal.begin(make_patch("file_a", 1, 2));
+        journal.begin(make_patch("file_b", 0, 3));
+        journal.end(first);
+    }
+    {
+        PatchJournal journal(dir);
+        auto pending = journal.pending();
+        check(pending.size() == 2, "journal: pending stripes after reopen");
+        check(pending.size() == 2 && pending[0].seq == second && same_patch(pending[0].patch, make_patch("file_a", 1, 2)),
+              "journal: pending stripe is replayed intact");
+        check(journal.pending("file_b").size() == 1, "journal: pending stripes by file");
+        journal.begin(make_patch("file_c", 0, 4));
+    }
+    fs::resize_file(path, fs::file_size(path) - 10);
+    {
+        PatchJournal journal(dir);
+        check(journal.pending().size() == 2 && journal.pending("file_c").empty(), "journal: torn begin is discarded");
+        // Un seq nuevo no reutiliza el de una franja pendiente
+        uint64_t seq = journal.begin(make_patch("file_d", 0, 5));
+        auto pending = journal.pending();
+        check(std::count_if(pending.begin(), pending.end(), [&](const auto& p) { return p.seq == seq; }) == 1,
+              "journal: new seq is unique after a torn tail");
+    }
+}
+
+// Al crecer compact_bytes el journal se reescribe solo con las pendientes
+void test_patch_journal_compaction(const fs::path& root) {
+    std::string dir = fresh_dir(root, "journal_compaction");
+    fs::path path = fs::path(dir) / "patch.journal";
+    constexpr size_t COMPACT = 4096;
+    uint64_t kept;
+    {
+        PatchJournal journal(dir, COMPACT);
+        kept = journal.begin(make_patch("file_keep", 7, 9));
+        for (int i = 0; i < 50; i++) journal.end(journal.begin(make_patch("file_a", i, static_cast<uint8_t>(i))));
+        check(fs::file_size(path) < 2 * COMPACT, "journal: compaction bounds the file size");
+    }
+    {
+        PatchJournal journal(dir, COMPACT);
+        auto pending = journal.pending();
+        check(pending.size() == 1 && pending[0].seq == kept && same_patch(pending[0].patch, make_patch("file_keep", 7, 9)),
+              "journal: compaction keeps the pending stripe");
+        journal.end(kept);
+    }
+    {
+        PatchJournal journal(dir, COMPACT);
+        check(journal.pending().empty(), "journal: end after compaction persists");
+    }
+}
+
+// Ids únicos y crecientes por hilo con varios hilos a la vez, y mayores que el último guardado
+void test_file_ids() {
+    constexpr int THREADS = 8, PER_THREAD = 20000;
+    FileIdGenerator generator(3);
+    std::vector<std::vector<uint64_t>> ids(THREADS);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([&, t] {
+            ids[t].reserve(PER_THREAD);
+            for (int i = 0; i < PER_THREAD; i++) ids[t].push_back(generator.next());
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    std::set<uint64_t> unique;
+    bool increasing = true;
+    for (const auto& list : ids) {
+        increasing = increasing && std::is_sorted(list.begin(), list.end()) &&
+                     std::adjacent_find(list.begin(), list.end()) == list.end();
+        unique.insert(list.begin(), list.end());
+    }
+    check(unique.size() == static_cast<size_t>(THREADS * PER_THREAD), "file_id: concurrent ids are unique");
+    check(increasing, "file_id: ids increase within each thread");
+    bool instance = std::all_of(unique.begin(), unique.end(), [](uint64_t id) {
+        return ((id >> FileIdGenerator::SEQUENCE_BITS) & ((1u << FileIdGenerator::INSTANCE_BITS) - 1)) == 3;
+    });
+    check(instance, "file_id: instance bits");
+
+    // Un id guardado "en el futuro" (reloj que retrocedió entre reinicios)
+    uint64_t future = *unique.rbegin() + (3600000ULL << (FileIdGenerator::INSTANCE_BITS + FileIdGenerator::SEQUENCE_BITS));
+    FileIdGenerator restarted(3);
+    restarted.resume_after(future);
+    uint64_t next = restarted.next();
+    check(next > future, "file_id: resume_after keeps ids above the stored one");
+    restarted.resume_after(*unique.begin());
+    check(restarted.next() > next, "file_id: resume_after never moves back");
+
+    std::string text = restarted.next_file_id();
+    uint64_t decoded = 0;
+    check(FileIdGenerator::decode_file_id(text, decoded) && FileIdGenerator::encode(decoded) == text.substr(5),
+          "file_id: decode_file_id round trip");
+    check(!FileIdGenerator::decode_file_id("file_1", decoded), "file_id: older ids are not decoded");
+    check(!FileIdGenerator::decode_file_id("file_z000000000000", decoded), "file_id: out of range id is rejected");
+}
+
+int main(int argc, char** argv) {
+    fs::path root = argc > 1 ? fs::path(argv[1]) : fs::temp_directory_path() / "proyecto_store_test";
+    fs::remove_all(root);
+
+    test_metadata_torn_tail(root);
+    test_metadata_snapshot_replay(root);
+    test_chunk_log_replay(root);
+    test_chunk_duplicate_add(root);
+    test_patch_journal_replay(root);
+    test_patch_journal_compaction(root);
+    test_file_ids();
+
+    fs::remove_all(root);
+    if (failures > 0) {
+        std::cerr << failures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "All checks passed\n";
+    return 0;
+}